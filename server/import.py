@@ -108,7 +108,7 @@ def get_name(G):
     G["group"] = p[-2]
 
 
-def gls_graph(G):
+def write_config(G):
     config = configparser.ConfigParser()
     config.optionxform = str
 
@@ -120,6 +120,21 @@ def gls_graph(G):
     with open("gls.ini", "w") as fp:
         config.write(fp)
 
+
+def importer():
+    return os.path.join(db, "bin", "import.exe")
+
+
+def import_graph(G, csv):
+    # converts, bounds, colors and appends the csv row in one native pass
+    write_config(G)
+    cmd = [importer(), G["source"], G["target"], G["color"], csv, G["group"], G["name"]]
+    return subprocess.call(cmd) == 0
+
+
+def gls_graph(G):
+    write_config(G)
+
     cmd = os.path.join(db, "bin", "gls.exe") + " " + G["target"]
 
     start = time.time()
@@ -130,6 +145,10 @@ def gls_graph(G):
     C = set()
     with open(G["color"], "r") as inp:
         line = inp.readline()
+        if line.strip() == "NO":
+            # the search did not find a coloring without conflicts
+            G["gls"] = "NO"
+            return
         line = inp.readline()
         while line:
             C.add(int(line.split(" ")[0]))
@@ -178,13 +197,19 @@ if __name__ == "__main__":
             G = {"source": s, "target": remove_extension(t), "color": remove_extension(c), "min": 2, "comment": ""}
             get_name(G)
             print(len(Q), G["group"], G["name"])
-            if G["group"] in NP:
-                stat_graph(G)
+            if G["group"] not in NP and os.path.isfile(importer()):
+                if not import_graph(G, csv):
+                    print("Import of " + G["source"] + " failed.")
+                    continue
             else:
-                parse_graph(G)
-            upper_bounds(G)
-            gls_graph(G)
-            append_graph(G, csv, ["group", "name", "N", "M", "deg_min", "deg_max", "deg_avg", "min", "d", "t2", "t3", "greedy", "gls", "gls_time", "comment"])
+                if G["group"] in NP:
+                    stat_graph(G)
+                else:
+                    # import.exe is not built, the DIMACS file is parsed here
+                    parse_graph(G)
+                upper_bounds(G)
+                gls_graph(G)
+                append_graph(G, csv, ["group", "name", "N", "M", "deg_min", "deg_max", "deg_avg", "min", "d", "t2", "t3", "greedy", "gls", "gls_time", "comment"])
             os.remove(G["source"])
             continue
 
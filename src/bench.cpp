@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+
+#include "../data_structure/graph.h"
+#include "../data_structure/compressed_graph.h"
+#include "../data_structure/io/graph_io.h"
+#include "../coloring/gls.h"
+#include "../coloring/score_kernels.h"
+
+/*
+ Compares the memory and the adjacency scan time of the graph representations.
+ If K is given, it also compares the layouts of the solver scores.
+
+ Usage: bench.exe graph [rounds] [K]
+
+ Every round visits all neighbour lists once, the same way the solver does in update_weights.
+ The score benchmark applies random moves the way make_move does and counts the distinct cache lines of the scores, which every move touches.
+Then it evaluates all rows of the scores with the portable and with the widest supported kernel of score_kernels.h.
+At last it counts the heap allocations of a search with count and with 10 * count iterations, aligned and array allocations included,
+once with and once without the move queues. The iterations themselves must not allocate, so the benchmark fails if the counts differ.
+*/
+
+// every operator new of the program is counted, the benchmark runs in one thread
+// GCC pairs the inlined operator new with the free of the replaced operator delete, the pairs below match
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+static unsigned long long allocations = 0;
+
+static void* counted(std::size_t size){
+	allocations++;
+	if(void* result = std::malloc(size ? size : 1)){ return result; }
+	throw std::bad_alloc();
+}
+
+// the pointer from malloc is kept in front of the aligned block
+static void* counted(std::size_t size, std::align_val_t alignment){
+	std::size_t align = static_cast<std::size_t>(alignment);
+	uintptr_t block = reinterpret_cast<uintptr_t>(counted(size + align + sizeof(void*)));
+	uintptr_t address = (block + sizeof(void*) + align - 1) & ~uintptr_t(align - 1);
+	reinterpret_cast<void**>(address)[-1] = reinterpret_cast<void*>(block);
+	return reinterpret_cast<void*>(address);
+}
+
+static void released(void* address, std::align_val_t){
+	if(address != NULL){ std::free(reinterpret_cast<void**>(address)[-1]); }
+}
+
+void* operator new(std::size_t size){ return counted(size); }
+void* operator new[](std::size_t size){ return counted(size); }
+void* operator new(std::size_t size, std::align_val_t alignment){ return counted(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment){ return counted(size, alignment); }
+
+void operator delete(void* address) noexcept { std::free(address); }
+void operator delete[](void* address) noexcept { std::free(address); }
+void operator delete(void* address, std::size_t) noexcept { std::free(address); }
+void operator delete[](void* address, std::size_t) noexcept { std::free(address); }
+void operator delete(void* address, std::align_val_t alignment) noexcept { released(address, alignment); }
+void operator delete[](void* address, std::align_val_t alignment) noexcept { released(address, alignment); }
+void operator delete(void* address, std::size_t, std::align_val_t alignment) noexcept { released(address, alignment); }
+void operator delete[](void* address, std::size_t, std::align_val_t alignment) noexcept { released(address, alignment); }
+#pragma GCC diagnostic pop
+
+template<typename Graph>
+static double scan(const Graph &G, unsigned rounds, unsigned long long &checksum){
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for(unsigned r = 0; r < rounds; r++){
+		NodeID N = G.number_of_nodes();
+		for(NodeID v = 0; v < N; v++){
+			EdgeID e = G.get_first_edge(v);
+			for(NodeID u: G.neighbours(v)){
+				checksum += (unsigned long long) u + e++;
+			}
+		}
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	return elapsed.count() / rounds;
+}
+
+// conflicts and guidance in two arrays of K * N entries
+struct separate_scores {
+	unsigned K;
+	std::vector<gls::delta> conflicts, guidance;
+	separate_scores(NodeID N, unsigned k) : K(k), conflicts(size_t(N) * k, 0), guidance(size_t(N) * k, 0) {}
+	gls::delta* conflict(NodeID v, unsigned c){ return &conflicts[size_t(K) * v + c]; }
+	gls::delta* guide(NodeID v, unsigned c){ return &guidance[size_t(K) * v + c]; }
+};
+
+// conflicts and guidance interleaved in rows, which start at cache lines
+struct interleaved_scores {
+	size_t stride;
+	gls::NodeColorScore* rows;
+	interleaved_scores(NodeID N, unsigned k) : stride((k + gls::SCORES_PER_LINE - 1) / gls::SCORES_PER_LINE * gls::SCORES_PER_LINE) {
+		rows = static_cast<gls::NodeColorScore*>(::operator new[](sizeof(gls::NodeColorScore) * stride * N, std::align_val_t(64)));
+		std::fill(rows, rows + stride * N, gls::NodeColorScore());
+	}
+	~interleaved_scores(){ ::operator delete[](rows, std::align_val_t(64)); }
+	gls::delta* conflict(NodeID v, unsigned c){ return &rows[stride * v + c].conflicts; }
+	gls::delta* guide(NodeID v, unsigned c){ return &rows[stride * v + c].guidance; }
+};
+
+// the moves are the same for both layouts, every one updates two scores of each neighbour and reads its whole row
+template<typename Scores>
+static double moves(const graph_access &G, Scores &S, unsigned K, unsigned count, long long &checksum, double &lines){
+	std::mt19937 random(1);
+	std::vector<uintptr_t> touched;
+	size_t total = 0;
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for(unsigned i = 0; i < count; i++){
+		NodeID v = random() % G.number_of_nodes();
+		unsigned from = random() % K, to = random() % K;
+		for(NodeID u: G.neighbours(v)){
+			(*S.conflict(u, from))--;
+			(*S.guide(u, from)) -= 1;
+			(*S.conflict(u, to))++;
+			(*S.guide(u, to)) += 1;
+		}
+		for(NodeID u: G.neighbours(v)){
+			for(unsigned c = 0; c < K; c++){
+				checksum += *S.conflict(u, c) - *S.conflict(u, from) + *S.guide(u, c) - *S.guide(u, from);
+			}
+		}
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	
+	// the lines are counted separately, so the counting does not add to the time
+	random.seed(1);
+	for(unsigned i = 0; i < count; i++){
+		NodeID v = random() % G.number_of_nodes();
+		random();
+		random();
+		for(NodeID u: G.neighbours(v)){
+			touched.clear();
+			for(unsigned c = 0; c < K; c++){
+				touched.push_back((uintptr_t) S.conflict(u, c) >> 6);
+				touched.push_back((uintptr_t) S.guide(u, c) >> 6);
+			}
+			std::sort(touched.begin(), touched.end());
+			total += std::unique(touched.begin(), touched.end()) - touched.begin();
+		}
+	}
+	lines = double(total) / count;
+	return elapsed.count();
+}
+
+// every round evaluates the moves of all nodes from their first color, the way make_move refreshes the moves of the neighbours
+static double evaluate(interleaved_scores &S, NodeID N, unsigned K, unsigned rounds, score_kernels::kernel<gls::delta> kernel, long long &checksum){
+	std::vector<int32_t> totals(K);
+	std::vector<uint64_t> ties((K + 63) / 64);
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for(unsigned r = 0; r < rounds; r++){
+		for(NodeID v = 0; v < N; v++){
+			checksum += kernel(&S.rows[S.stride * v].conflicts, 0, K, 10, totals.data(), ties.data()) + totals[K - 1] + (long long) ties[0];
+		}
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	return elapsed.count() / rounds;
+}
+
+// the first search sizes the buffers of the solver, the second one is counted
+static unsigned long long search(const graph_access &G, unsigned K, unsigned iterations, unsigned queue){
+	gls::MOVE_QUEUE = queue;
+	gls::TIMEOUT = 0;
+	gls::MAX_NO_IMPROVE = 0;
+	gls::MAX_ITER = iterations;
+	gls::GuidedLocalSearch<gls::delta> solver;
+	std::mt19937 random(1);
+	gls::colors coloring = gls::ColoringBuilder::random(G, K, random);
+	solver.prepare(G, coloring, K);
+	solver.solve(G, coloring, K);
+	
+	solver.prepare(G, coloring, K);
+	unsigned long long before = allocations;
+	solver.solve(G, coloring, K);
+	return allocations - before;
+}
+
+int main(int argc, const char* argv[]) {
+	if(argc < 2){
+		std::cerr << "Usage: " << argv[0] << " graph [rounds] [K]" << std::endl;
+		return 1;
+	}
+	unsigned rounds = argc > 2 ? atoi(argv[2]) : 10;
+	if(rounds == 0){ rounds = 1; }
+
+	graph_access G;
+	if(graph_io::readGraph(G, argv[1])){
+		return 1;
+	}
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	compressed_graph C(G);
+	std::chrono::duration<double, std::milli> build = std::chrono::high_resolution_clock::now() - start;
+
+	unsigned long long csr_checksum = 0, compressed_checksum = 0;
+	// warm up the caches for both representations
+	scan(G, 1, csr_checksum);
+	scan(C, 1, compressed_checksum);
+	csr_checksum = compressed_checksum = 0;
+
+	double csr_time = scan(G, rounds, csr_checksum);
+	double compressed_time = scan(C, rounds, compressed_checksum);
+
+	size_t csr_memory = (size_t(G.number_of_nodes()) + 1) * sizeof(EdgeID) + size_t(G.number_of_edges()) * sizeof(NodeID);
+	size_t compressed_memory = C.memory();
+
+	std::cout << "nodes " << G.number_of_nodes() << " edges " << G.number_of_edges() << std::endl;
+	std::cout << "csr        memory " << csr_memory << " bytes, scan " << csr_time << " ms" << std::endl;
+	std::cout << "compressed memory " << compressed_memory << " bytes, scan " << compressed_time << " ms, build " << build.count() << " ms" << std::endl;
+	std::cout << "memory ratio " << double(compressed_memory) / double(csr_memory)
+		<< ", scan ratio " << compressed_time / csr_time << std::endl;
+
+	if(csr_checksum != compressed_checksum){
+		std::cerr << "The compressed graph has different adjacencies" << std::endl;
+		return 1;
+	}
+	
+	if(argc > 3){
+		unsigned K = atoi(argv[3]);
+		unsigned count = 1000 * rounds;
+		if(K == 0 || G.number_of_nodes() == 0){ return 0; }
+		long long separate_checksum = 0, interleaved_checksum = 0;
+		double separate_lines = 0, interleaved_lines = 0;
+		
+		separate_scores S(G.number_of_nodes(), K);
+		double separate_time = moves(G, S, K, count, separate_checksum, separate_lines);
+		interleaved_scores I(G.number_of_nodes(), K);
+		double interleaved_time = moves(G, I, K, count, interleaved_checksum, interleaved_lines);
+		
+		std::cout << "separate    scores " << separate_time << " ms, " << separate_lines << " cache lines per move" << std::endl;
+		std::cout << "interleaved scores " << interleaved_time << " ms, " << interleaved_lines << " cache lines per move" << std::endl;
+		if(separate_checksum != interleaved_checksum){
+			std::cerr << "The score layouts have different results" << std::endl;
+			return 1;
+		}
+		
+		long long portable_checksum = 0, vector_checksum = 0;
+		score_kernels::Level level = score_kernels::supported();
+		double portable_time = evaluate(I, G.number_of_nodes(), K, rounds, score_kernels::select<gls::delta>(score_kernels::Portable), portable_checksum);
+		double vector_time = evaluate(I, G.number_of_nodes(), K, rounds, score_kernels::select<gls::delta>(level), vector_checksum);
+		std::cout << "portable kernel " << portable_time << " ms, " << (level == score_kernels::AVX512 ? "AVX-512" : level == score_kernels::AVX2 ? "AVX2" : "portable")
+			<< " kernel " << vector_time << " ms" << std::endl;
+		if(portable_checksum != vector_checksum){
+			std::cerr << "The kernels have different results" << std::endl;
+			return 1;
+		}
+		
+		for(unsigned queue = 0; queue <= 1; queue++){
+			unsigned long long few = search(G, K, count, queue), many = search(G, K, 10 * count, queue);
+			std::cout << "search allocations " << (queue ? "with" : "without") << " queues " << few << " in " << count << " iterations, "
+				<< many << " in " << 10 * count << " iterations" << std::endl;
+			if(many != few){
+				std::cerr << "The search allocates in the iterations" << std::endl;
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,193 @@
+/******************************************************************************
+ * compressed_graph.h
+ *
+ * Read-only graph with byte-aligned compressed adjacencies. Every sorted
+ * neighbour list is stored as varint gaps and decoded on the fly while it is
+ * iterated, so the targets take one or two bytes instead of sizeof(NodeID)
+ * on sparse graphs with local node IDs.
+ *****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "graph.h"
+
+class compressed_graph {
+public:
+    compressed_graph() : m_max_degree(0) {
+        m_first_edge.push_back(0);
+        m_first_byte.push_back(0);
+    }
+
+    template <typename Graph>
+    explicit compressed_graph(const Graph & G) : m_max_degree(0) {
+        build(G);
+    }
+
+    template <typename Graph>
+    void build(const Graph & G);
+
+    /* ============================================================= */
+    /* graph access methods, the same as in graph_access */
+    /* ============================================================= */
+    NodeID number_of_nodes() const {
+        return m_first_edge.size() - 1;
+    }
+
+    EdgeID number_of_edges() const {
+        return m_first_edge.back();
+    }
+
+    // edge ids are the positions in the sorted adjacency, they index per edge arrays of the solver
+    EdgeID get_first_edge(NodeID node) const {
+        return m_first_edge[node];
+    }
+
+    EdgeID get_first_invalid_edge(NodeID node) const {
+        return m_first_edge[node + 1];
+    }
+
+    EdgeID getNodeDegree(NodeID node) const {
+        return m_first_edge[node + 1] - m_first_edge[node];
+    }
+
+    EdgeID getMaxDegree() const {
+        return m_max_degree;
+    }
+
+    // bytes used by the adjacency structure
+    size_t memory() const {
+        return m_first_edge.size() * sizeof(EdgeID) + m_first_byte.size() * sizeof(uint64_t) + m_bytes.size();
+    }
+
+    class adjacency_iterator {
+    public:
+        adjacency_iterator(const uint8_t* pos, NodeID source, EdgeID remaining)
+            :   m_pos(pos)
+            ,   m_remaining(remaining)
+            ,   m_current(0)
+        {
+            if (m_remaining > 0) {
+                // the first target is a zigzag coded difference to the source
+                uint64_t code = decode(m_pos);
+                int64_t diff = (int64_t) (code >> 1) ^ -(int64_t) (code & 1);
+                m_current = (NodeID) ((int64_t) source + diff);
+            }
+        }
+
+        NodeID operator* () const {
+            return m_current;
+        }
+
+        adjacency_iterator operator++ () {
+            if (--m_remaining > 0) {
+                m_current += (NodeID) decode(m_pos) + 1;
+            }
+            return *this;
+        }
+
+        bool operator== (const adjacency_iterator& other) const {
+            return m_remaining == other.m_remaining;
+        }
+
+        bool operator!= (const adjacency_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        const uint8_t* m_pos;
+        EdgeID m_remaining;
+        NodeID m_current;
+    };
+
+    class adjacency_adapter {
+    public:
+        adjacency_adapter(const compressed_graph& _G, NodeID _n)
+            :   G(_G)
+            ,   n(_n)
+        {}
+
+        adjacency_iterator begin() const {
+            return adjacency_iterator(G.m_bytes.data() + G.m_first_byte[n], n, G.getNodeDegree(n));
+        }
+
+        adjacency_iterator end() const {
+            return adjacency_iterator(NULL, n, 0);
+        }
+
+    private:
+        const compressed_graph& G;
+        NodeID n;
+    };
+
+    adjacency_adapter neighbours(NodeID n) const {
+        return adjacency_adapter(*this, n);
+    }
+
+    // LEB128: seven bits per byte, the high bit marks that more bytes follow
+    static inline uint64_t decode(const uint8_t* & pos) {
+        uint64_t byte = *pos++;
+        if (byte < 0x80) {
+            return byte;
+        }
+        uint64_t value = byte & 0x7f;
+        unsigned shift = 7;
+        do {
+            byte = *pos++;
+            value |= (byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte >= 0x80);
+        return value;
+    }
+
+    static inline void encode(std::vector<uint8_t> & bytes, uint64_t value) {
+        while (value >= 0x80) {
+            bytes.push_back((uint8_t) (value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back((uint8_t) value);
+    }
+
+private:
+    std::vector<EdgeID> m_first_edge;
+    std::vector<uint64_t> m_first_byte;
+    std::vector<uint8_t> m_bytes;
+    EdgeID m_max_degree;
+};
+
+template <typename Graph>
+void compressed_graph::build(const Graph & G) {
+    NodeID n = G.number_of_nodes();
+    m_first_edge.assign(1, 0);
+    m_first_byte.assign(1, 0);
+    m_first_edge.reserve(n + 1);
+    m_first_byte.reserve(n + 1);
+    m_bytes.clear();
+    m_max_degree = 0;
+
+    std::vector<NodeID> adjacency;
+    for (NodeID v = 0; v < n; ++v) {
+        adjacency.clear();
+        for (NodeID u : G.neighbours(v)) {
+            adjacency.push_back(u);
+        }
+        std::sort(adjacency.begin(), adjacency.end());
+
+        for (size_t i = 0; i < adjacency.size(); ++i) {
+            if (i == 0) {
+                int64_t diff = (int64_t) adjacency[0] - (int64_t) v;
+                encode(m_bytes, ((uint64_t) diff << 1) ^ (uint64_t) (diff >> 63));
+            } else {
+                encode(m_bytes, adjacency[i] - adjacency[i - 1] - 1);
+            }
+        }
+
+        m_first_edge.push_back(m_first_edge.back() + adjacency.size());
+        m_first_byte.push_back(m_bytes.size());
+        m_max_degree = std::max<EdgeID>(m_max_degree, adjacency.size());
+    }
+    m_bytes.shrink_to_fit();
+}
@@ -0,0 +1,185 @@
+/******************************************************************************
+ * dense_graph.h
+ *
+ * Read-only graph with one adjacency bitset per node. On dense graphs the
+ * rows take less memory than the CSR targets and neighbourhood queries
+ * against node sets reduce to popcounts of word-wise ANDs.
+ *****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "graph.h"
+#include "popcount.h"
+
+class dense_graph {
+public:
+    template <typename Graph>
+    explicit dense_graph(const Graph & G);
+
+    // ratio of the directed edges to the N * (N - 1) possible ones
+    template <typename Graph>
+    static double density(const Graph & G) {
+        double n = G.number_of_nodes();
+        return n > 1 ? double(G.number_of_edges()) / (n * (n - 1)) : 0.0;
+    }
+
+    /* ============================================================= */
+    /* graph access methods, the same as in graph_access */
+    /* ============================================================= */
+    NodeID number_of_nodes() const {
+        return m_first_edge.size() - 1;
+    }
+
+    EdgeID number_of_edges() const {
+        return m_first_edge.back();
+    }
+
+    // edge ids are the ranks of the targets in the rows, they index per edge arrays of the solver
+    EdgeID get_first_edge(NodeID node) const {
+        return m_first_edge[node];
+    }
+
+    EdgeID get_first_invalid_edge(NodeID node) const {
+        return m_first_edge[node + 1];
+    }
+
+    EdgeID getNodeDegree(NodeID node) const {
+        return m_first_edge[node + 1] - m_first_edge[node];
+    }
+
+    EdgeID getMaxDegree() const {
+        return m_max_degree;
+    }
+
+    /* ============================================================= */
+    /* bitset methods */
+    /* ============================================================= */
+    // 64-bit words in a row and in every node set built by node_sets
+    size_t words() const {
+        return m_words;
+    }
+
+    const uint64_t* row(NodeID node) const {
+        return &m_rows[node * m_words];
+    }
+
+    bool is_edge(NodeID source, NodeID target) const {
+        return (row(source)[target >> 6] >> (target & 63)) & 1;
+    }
+
+    // fills sets with k bitsets of words() words, the set c has the nodes with part[v] == c
+    template <typename Partition>
+    void node_sets(const Partition & part, unsigned k, std::vector<uint64_t> & sets) const {
+        sets.assign(k * m_words, 0);
+        for (NodeID v = 0, n = number_of_nodes(); v < n; ++v) {
+            sets[part[v] * m_words + (v >> 6)] |= uint64_t(1) << (v & 63);
+        }
+    }
+
+    // number of neighbours of node in the set
+    size_t count_neighbours(NodeID node, const uint64_t* set) const {
+        return popcount::count_and(row(node), set, m_words);
+    }
+
+    class adjacency_iterator {
+    public:
+        adjacency_iterator(const uint64_t* row, size_t words, size_t word)
+            :   m_row(row)
+            ,   m_words(words)
+            ,   m_word(word)
+            ,   m_bits(0)
+        {
+            if (m_word < m_words) {
+                m_bits = m_row[m_word];
+                skip();
+            }
+        }
+
+        NodeID operator* () const {
+            return (NodeID) (m_word * 64 + popcount::lowest(m_bits));
+        }
+
+        adjacency_iterator operator++ () {
+            m_bits &= m_bits - 1;
+            skip();
+            return *this;
+        }
+
+        bool operator== (const adjacency_iterator& other) const {
+            return m_word == other.m_word && m_bits == other.m_bits;
+        }
+
+        bool operator!= (const adjacency_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        void skip() {
+            while (m_bits == 0 && ++m_word < m_words) {
+                m_bits = m_row[m_word];
+            }
+        }
+
+        const uint64_t* m_row;
+        size_t m_words;
+        size_t m_word;
+        uint64_t m_bits;
+    };
+
+    class adjacency_adapter {
+    public:
+        adjacency_adapter(const dense_graph& _G, NodeID _n)
+            :   G(_G)
+            ,   n(_n)
+        {}
+
+        adjacency_iterator begin() const {
+            return adjacency_iterator(G.row(n), G.m_words, 0);
+        }
+
+        adjacency_iterator end() const {
+            return adjacency_iterator(G.row(n), G.m_words, G.m_words);
+        }
+
+    private:
+        const dense_graph& G;
+        NodeID n;
+    };
+
+    adjacency_adapter neighbours(NodeID n) const {
+        return adjacency_adapter(*this, n);
+    }
+
+private:
+    size_t m_words;
+    std::vector<uint64_t> m_rows;
+    std::vector<EdgeID> m_first_edge;
+    EdgeID m_max_degree;
+};
+
+template <typename Graph>
+dense_graph::dense_graph(const Graph & G) : m_max_degree(0) {
+    NodeID n = G.number_of_nodes();
+    m_words = (n + 63) / 64;
+    m_rows.assign(n * m_words, 0);
+    m_first_edge.assign(n + 1, 0);
+
+    for (NodeID v = 0; v < n; ++v) {
+        uint64_t* bits = &m_rows[v * m_words];
+        for (NodeID u : G.neighbours(v)) {
+            bits[u >> 6] |= uint64_t(1) << (u & 63);
+        }
+
+        // parallel edges collapse into one bit
+        EdgeID degree = 0;
+        for (size_t w = 0; w < m_words; ++w) {
+            degree += popcount::word(bits[w]);
+        }
+        m_first_edge[v + 1] = m_first_edge[v] + degree;
+        m_max_degree = std::max(m_max_degree, degree);
+    }
+}
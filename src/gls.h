@@ -11,14 +11,31 @@
 #include "../lib/SimpleIni.h"
 #define CONFIG "gls.ini"
 
+#include "../data_structure/dense_graph.h"
+#include "../data_structure/parallel.h"
+#include "score_kernels.h"
+
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <sstream>
 #include <vector>
 #include <queue>
 #include <stack>
+#include <tuple>
 #include <set>
 #include <ctime>
 #include <limits>
 #include <chrono>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <xmmintrin.h>
+#endif
 #define SENTINEL(T) (T{})
 
 
@@ -42,23 +59,74 @@ namespace gls {
 	*/
 	typedef uint color;
 	
+	/* Type: moveid
+	Alias for the ID of a move, which is K * node + color. It is 64 bit wide, if GLS_64BIT is defined.
+	*/
+	/* Type: scoresum
+	Alias for the sums of conflicts and guidance over the whole coloring. It is 64 bit wide, if GLS_64BIT is defined.
+	*/
+	#ifdef GLS_64BIT
+	typedef uint64_t moveid;
+	typedef uint64_t scoresum;
+	#else
+	typedef uint moveid;
+	typedef uint scoresum;
+	#endif
+	
 	/* Type: delta
-	Alias for a signed int, representing an improvement or a score structure.
+	Alias for a signed short, representing an improvement or a score structure. It is the narrow score type of <GuidedLocalSearch>.
 	*/
 	typedef signed short delta;
 	
+	/* Type: wide_delta
+	Alias for a signed int, the wide score type of <GuidedLocalSearch>, see SCORE_BITS.
+	*/
+	typedef int32_t wide_delta;
+	
+	/* Struct: BasicNodeColorScore
+	Conflicts and guidance of a node with a color in the score type T. They are kept together, because the search always reads and writes both.
+	*/
+	template<typename T>
+	struct BasicNodeColorScore{
+		T conflicts;
+		T guidance;
+	};
+	
+	/* Type: NodeColorScore
+	Alias for BasicNodeColorScore<delta>.
+	*/
+	typedef BasicNodeColorScore<delta> NodeColorScore;
+	
+	/* Function: scores_per_line
+	Number of BasicNodeColorScore<T> in a cache line of 64 bytes, the rows of the scores of the nodes are padded to it.
+	*/
+	template<typename T>
+	constexpr uint scores_per_line(){
+		return 64 / sizeof(BasicNodeColorScore<T>);
+	}
+	
+	/* Constant: SCORES_PER_LINE
+	Number of NodeColorScore in a cache line of 64 bytes.
+	*/
+	const uint SCORES_PER_LINE = scores_per_line<delta>();
+	
 	/* Type: colors
 	Alias for std::vector<color>.
 	*/
 	typedef typename std::vector<color> colors;
+	
+	/* Type: nodes
+	Alias for std::vector<NodeID>.
+	*/
+	typedef typename std::vector<NodeID> nodes;
 
 	/* Type: upair
-	Alias for std::pair<uint, uint>.
+	Alias for std::pair<NodeID, NodeID>.
 	*/
-	typedef typename std::pair<uint, uint> upair;
+	typedef typename std::pair<NodeID, NodeID> upair;
 	
 	/* Type: upairs
-	Alias for std::vector<std::pair<uint, uint>>.
+	Alias for std::vector<std::pair<NodeID, NodeID>>.
 	*/
 	typedef typename std::vector<upair> upairs;
 	
@@ -69,6 +137,27 @@ namespace gls {
 		return (i.second > j.second); 
 	}
 	
+	/* Function: prefetch
+	Hints the processor to load the cache line of the address, which is read soon.
+	*/
+	inline void prefetch(const void* address) {
+	#if defined(_MSC_VER) && !defined(__clang__)
+		_mm_prefetch((const char*) address, _MM_HINT_T0);
+	#else
+		__builtin_prefetch(address);
+	#endif
+	}
+	
+	/* Function: mix
+	The SplitMix64 finalizer, a fast hash of 64-bit integers.
+	*/
+	inline uint64_t mix(uint64_t x) {
+		x += 0x9e3779b97f4a7c15ULL;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+		return x ^ (x >> 31);
+	}
+	
 	/*
 	 * ===========
 	 * Enumeratons
@@ -80,8 +169,13 @@ namespace gls {
 	RandomStart - Builds a random coloring, which may have initial conflicts.
 	Greedy      - Use a greedy algorithm to build a coloring, which is garanted to not have initial conflicts.
 	Bipartite   - Make a coloring with two colors, using a modified DFS. The coloring may have initial conflicts.
+	Dsatur      - Use the DSATUR algorithm of Brelaz, which colors the node with the most distinct neighbour colors first. The coloring has no initial conflicts.
+	LargestFirst    - Greedy coloring in descending order of the degrees. The coloring has no initial conflicts.
+	SmallestLast    - Greedy coloring in reverse degeneracy order, it uses at most degeneracy + 1 colors. The coloring has no initial conflicts.
+	IncidenceDegree - Greedy coloring, which takes next the node with the most colored neighbours. The coloring has no initial conflicts.
+	JonesPlassmann  - Parallel greedy coloring on the worker threads, by degree and random priorities. The coloring has no initial conflicts.
 	*/
-	enum BuildStrategy{ RandomStart, Greedy, Bipartite };
+	enum BuildStrategy{ RandomStart, Greedy, Bipartite, Dsatur, LargestFirst, SmallestLast, IncidenceDegree, JonesPlassmann };
 
 	/* Enum: EpocheStrategy
 	What to do between two sequent epoches -> going form k colors to k-1 colors in the searched coloring.
@@ -109,8 +203,9 @@ namespace gls {
 	Simple   - Use the Brooks theorem. 
 	Theorem2 - Use Theorem 2.
 	Theorem3 - Use Theorem 3.
+	Degeneracy - Use the degeneracy + 1, the number of colors of the smallest-last greedy coloring is at most that.
 	*/
-	enum ColoringUpperBoundMethod{ Simple, Theorem2, Theorem3 };
+	enum ColoringUpperBoundMethod{ Simple, Theorem2, Theorem3, Degeneracy };
 	
 	/* Enum: SolveResolution
 	Resolution of the GLS iterations.
@@ -124,6 +219,16 @@ namespace gls {
 	*/
 	enum SolveResolution{ NotFound, Solved, NoImprove, LocalMin, MaxIterations, Timeout };
 	
+	/* Enum: ReorderStrategy
+	How to relabel the nodes before solving, so that the conflicts rows of neighbours are close in memory.
+	
+	NoReorder    - Keep the original node IDs.
+	CuthillMcKee - Reverse Cuthill-McKee order.
+	BreadthFirst - Breadth-first order, starting every component from a node with minimal degree.
+	DegreeSorted - Nodes sorted by their degrees in descending order.
+	*/
+	enum ReorderStrategy{ NoReorder, CuthillMcKee, BreadthFirst, DegreeSorted };
+	
 	/*
 	 * =============
 	 * Configuration
@@ -146,7 +251,21 @@ namespace gls {
 	uint DYNAMIC_LAMBDA 					- Sets lambda dynamiclly to the average conflicts decrease before guidance is used.
 	uint ASPIRATION 						- Enables the aspiration moves. Default: *Yes*
 	uint TIMEOUT 							- Maximum execution time of GLS in seconds. Default: *120*
+	uint SCORE_BITS 						- Width of the scores of the search, 16 or 32. 0 chooses it from the maximal degree and the expected weight growth. Default: *0*
 	uint DEBUG 								- Bitwise AND mask of debug levels. Default: *0*
+	ReorderStrategy REORDER 				- How to relabel the nodes before solving. Default: *NoReorder*
+	uint COMPRESS_GRAPH 					- Solve on the varint compressed adjacencies of the graph. Default: *No*
+	uint DENSE_THRESHOLD 					- Density in percent, from which the bitset adjacencies are used. 0 disables them. Default: *40*
+	uint PEEL 								- Run every k-coloring epoche only on the k-core of the graph. Default: *No*
+	uint REDUCE 							- Remove the dominated nodes before solving. Default: *No*
+	uint COMPONENTS 						- Solve the connected components separately. Default: *No*
+	uint RLF_RESIDUAL 						- Extract independent sets until at most this many nodes are left and search only on them, 0 disables the extraction. Default: *0*
+	uint CLIQUE_BOUND 						- Raise the lower bound to the size of a heuristically found clique. Default: *No*
+	uint CLIQUE_STARTS 						- Number of the nodes with highest degrees, from which cliques are built. Default: *32*
+	uint SPECTRAL_BOUND 					- Raise the lower bound to the Hoffman bound of the adjacency eigenvalues. Default: *No*
+	uint SPECTRAL_STEPS 					- Maximum number of Lanczos steps for the eigenvalues. Default: *300*
+	uint THREADS 							- Number of worker threads, 0 uses all hardware threads. Default: *0*
+	uint SEED 								- Seed of the random choices of the builders and the search, and of the node priorities of the parallel builder. Default: *0*
 	*/
 	BuildStrategy BUILD_STRATEGY = BuildStrategy::Greedy; 
 	EpocheStrategy UPDATE_STRATEGY = EpocheStrategy::Merge;
@@ -158,14 +277,29 @@ namespace gls {
 	uint MAX_ITER = 0;
 	uint MAX_PLATAEU = 2;
 	uint MAX_NO_IMPROVE = 20000;
-	delta LAMBDA = 10;
+	// DYNAMIC_LAMBDA changes it during a search, so every worker thread has its own copy
+	thread_local delta LAMBDA = 10;
 	uint MOVE_QUEUE=1;
 	uint HEAD_CAPACITY=1;
 	uint DYNAMIC_LAMBDA = 1;
 	uint ASPIRATION = 1;
 	uint FAST_SEARCH = 1;
 	uint TIMEOUT = 120;
+	uint SCORE_BITS = 0;
 	uint DEBUG = 0;
+	ReorderStrategy REORDER = ReorderStrategy::NoReorder;
+	uint COMPRESS_GRAPH = 0;
+	uint DENSE_THRESHOLD = 40;
+	uint PEEL = 0;
+	uint REDUCE = 0;
+	uint COMPONENTS = 0;
+	uint RLF_RESIDUAL = 0;
+	uint CLIQUE_BOUND = 0;
+	uint CLIQUE_STARTS = 32;
+	uint SPECTRAL_BOUND = 0;
+	uint SPECTRAL_STEPS = 300;
+	uint THREADS = 0;
+	uint SEED = 0;
 	
 	/* Constants: Debug levels
 	uint DEBUG_OUTPUT 					- Output the best found graph coloring.
@@ -213,7 +347,26 @@ namespace gls {
 		FAST_SEARCH = atoi(ini.GetValue("gls", "FAST_SEARCH", "1"));
 		ASPIRATION = atoi(ini.GetValue("gls", "ASPIRATION", "1"));
 		TIMEOUT = atoi(ini.GetValue("gls", "TIMEOUT", "120"));
+		SCORE_BITS = atoi(ini.GetValue("gls", "SCORE_BITS", "0"));
 		DEBUG = atoi(ini.GetValue("gls", "DEBUG", "0"));
+		REORDER = static_cast<ReorderStrategy>(atoi(ini.GetValue("gls", "REORDER", "0")));
+		COMPRESS_GRAPH = atoi(ini.GetValue("gls", "COMPRESS_GRAPH", "0"));
+		DENSE_THRESHOLD = atoi(ini.GetValue("gls", "DENSE_THRESHOLD", "40"));
+		PEEL = atoi(ini.GetValue("gls", "PEEL", "0"));
+		REDUCE = atoi(ini.GetValue("gls", "REDUCE", "0"));
+		COMPONENTS = atoi(ini.GetValue("gls", "COMPONENTS", "0"));
+		RLF_RESIDUAL = atoi(ini.GetValue("gls", "RLF_RESIDUAL", "0"));
+		CLIQUE_BOUND = atoi(ini.GetValue("gls", "CLIQUE_BOUND", "0"));
+		CLIQUE_STARTS = atoi(ini.GetValue("gls", "CLIQUE_STARTS", "32"));
+		SPECTRAL_BOUND = atoi(ini.GetValue("gls", "SPECTRAL_BOUND", "0"));
+		SPECTRAL_STEPS = atoi(ini.GetValue("gls", "SPECTRAL_STEPS", "300"));
+		THREADS = atoi(ini.GetValue("gls", "THREADS", "0"));
+		SEED = atoi(ini.GetValue("gls", "SEED", "0"));
+		parallel::thread_limit() = THREADS;
+		if(SCORE_BITS != 0 && SCORE_BITS != 16 && SCORE_BITS != 32){
+			std::cout << "Not supported score width" << std::endl; 
+			exit(1);
+		}
 		if(BUILD_STRATEGY != BuildStrategy::RandomStart && UPDATE_STRATEGY == EpocheStrategy::Scratch){
 			std::cout << "Scratch is supported only for random start" << std::endl; 
 			exit(1);
@@ -240,20 +393,20 @@ namespace gls {
 		/* Field: conflicts
 		Conflicts of the coloring.
 		*/
-		uint conflicts = 0;
+		scoresum conflicts = 0;
 		/* Field: guidance
 		Guidance of the coloring.
 		*/
-		uint guidance = 0;
+		scoresum guidance = 0;
 		/* Field: total
 		Total score of the coloring. For implementation reasons it is equal to 10*conflicts + LAMBDA * guidance.
 		*/
-		uint total = 0;
+		scoresum total = 0;
 		
 		/* Field: total
 		Build a score by given conflicts and guidance
 		*/
-		inline static Score build(const uint &c, const uint &g){
+		inline static Score build(const scoresum &c, const scoresum &g){
 			Score result;
 			result.conflicts = c;
 			result.guidance = g;
@@ -262,43 +415,52 @@ namespace gls {
 		}
 	};
 	
-	/* Struct: DeltaScore
-	GLS delta score of a coloring in a given and the previous moment.
+	/* Struct: BasicDeltaScore
+	GLS delta score of a coloring in a given and the previous moment, with fields of the score type T.
 	*/
-	struct DeltaScore{
+	template<typename T>
+	struct BasicDeltaScore{
 		/* Field: conflicts
 		Conflicts of the coloring.
 		*/
-		delta conflicts = 0;
+		T conflicts = 0;
 		/* Field: guidance
 		Guidance of the coloring.
 		*/
-		delta guidance = 0;
+		T guidance = 0;
 		/* Field: total
 		Total score of the coloring. For implementation reasons it is equal to 10*conflicts + LAMBDA * guidance.
 		*/
-		delta total = 0;
+		T total = 0;
 		
 		/* Field: total
-		Build a score by given conflicts and guidance
+		Build a score by given conflicts and guidance. Debug builds check, that the total fits in T.
 		*/
-		inline static DeltaScore build(const delta &c, const delta &g){
-			DeltaScore result;
+		inline static BasicDeltaScore build(const T &c, const T &g){
+			BasicDeltaScore result;
 			result.conflicts = c;
 			result.guidance = g;
-			result.total = (g) ? 10 * c + LAMBDA * g : 10 * c;
+			int64_t total = (g) ? 10 * (int64_t) c + (int64_t) LAMBDA * g : 10 * (int64_t) c;
+			assert(total >= std::numeric_limits<T>::min() && total <= std::numeric_limits<T>::max());
+			result.total = (T) total;
 			return result;
 		}
 	};
 	
-	/* Struct: Move
-	GLS iteration move
+	/* Type: DeltaScore
+	Alias for BasicDeltaScore<delta>.
 	*/
-	struct Move{
+	typedef BasicDeltaScore<delta> DeltaScore;
+	
+	/* Struct: BasicMove
+	GLS iteration move with a delta score of the score type T.
+	*/
+	template<typename T>
+	struct BasicMove{
 		/* Field: ID
 		ID of the move = K * node + to
 		*/
-		uint ID = -1;
+		moveid ID = -1;
 		/* Field: node
 		Which node to update.
 		*/
@@ -310,88 +472,106 @@ namespace gls {
 		/* Field: score
 		Delta score a.k.a score step of the move.
 		*/
-		DeltaScore score;
+		BasicDeltaScore<T> score;
 		
-		Move(){}
-		Move(const NodeID n, const color t, const color K){
-			ID = K * n + t;
+		BasicMove(){}
+		BasicMove(const NodeID n, const color t, const color K){
+			ID = (moveid) K * n + t;
 			node = n;
 			to = t;
 		}
 	};
 	
+	/* Type: Move
+	Alias for BasicMove<delta>.
+	*/
+	typedef BasicMove<delta> Move;
+	
 	/* Type: Moves
 	Alias for std::vector<Move>.
 	*/
 	typedef typename std::vector<Move> Moves;
 	
-	/* Type: MovesQueueNode
+	/* Type: BasicMovesQueueNode
 	Combination of ID and score.
 	*/
-	struct MovesQueueNode{
+	template<typename T>
+	struct BasicMovesQueueNode{
 		size_t node;
-		DeltaScore score;
-		MovesQueueNode(size_t n, DeltaScore s){
+		BasicDeltaScore<T> score;
+		BasicMovesQueueNode(size_t n, BasicDeltaScore<T> s){
 			node=n; score=s;
 		}
 	};
 	
-	/* Type: MoveTotalCompare
+	/* Type: BasicMoveTotalCompare
 	Compare moves based on their augumented score, ID
 	*/
-	struct MoveTotalCompare{
-		bool operator()(const Move& a, const Move& b) const {
+	template<typename T>
+	struct BasicMoveTotalCompare{
+		bool operator()(const BasicMove<T>& a, const BasicMove<T>& b) const {
 			if (a.score.total == b.score.total){ 
 				return a.ID < b.ID;
 			}
 			return a.score.total < b.score.total;
 		}
 		
-		bool operator()(const MovesQueueNode& a, const MovesQueueNode& b) const {
+		bool operator()(const BasicMovesQueueNode<T>& a, const BasicMovesQueueNode<T>& b) const {
 			return a.score.total <= b.score.total;
 		}
 		
-		bool weak(const MovesQueueNode& a, const MovesQueueNode& b) const {
+		bool weak(const BasicMovesQueueNode<T>& a, const BasicMovesQueueNode<T>& b) const {
 			return a.score.total < b.score.total;
 		}
 		
-		bool operator()(const DeltaScore& a, const DeltaScore& b) const {
+		bool operator()(const BasicDeltaScore<T>& a, const BasicDeltaScore<T>& b) const {
 			return a.total <= b.total;
 		}
 		
-		bool weak(const DeltaScore& a, const DeltaScore& b) const {
+		bool weak(const BasicDeltaScore<T>& a, const BasicDeltaScore<T>& b) const {
 			return a.total < b.total;
 		}
 	};
 	
-	/* Type: MoveConflictsCompare
+	/* Type: BasicMoveConflictsCompare
 	Compare moves based on their conflicts score, ID
 	*/
-	struct MoveConflictsCompare{
-		bool operator()(const Move& a, const Move& b) const {
+	template<typename T>
+	struct BasicMoveConflictsCompare{
+		bool operator()(const BasicMove<T>& a, const BasicMove<T>& b) const {
 			if (a.score.conflicts == b.score.conflicts){ 
 				return a.ID < b.ID;
 			}
 			return a.score.conflicts < b.score.conflicts;
 		}
 		
-		bool operator()(const MovesQueueNode& a, const MovesQueueNode& b) const {
+		bool operator()(const BasicMovesQueueNode<T>& a, const BasicMovesQueueNode<T>& b) const {
 			return a.score.conflicts <= b.score.conflicts;
 		}
 		
-		bool weak(const MovesQueueNode& a, const MovesQueueNode& b) const {
+		bool weak(const BasicMovesQueueNode<T>& a, const BasicMovesQueueNode<T>& b) const {
 			return a.score.conflicts < b.score.conflicts;
 		}
 				
-		bool operator()(const DeltaScore& a, const DeltaScore& b) const {
+		bool operator()(const BasicDeltaScore<T>& a, const BasicDeltaScore<T>& b) const {
 			return a.total <= b.total;
 		}
 		
-		bool weak(const DeltaScore& a, const DeltaScore& b) const {
+		bool weak(const BasicDeltaScore<T>& a, const BasicDeltaScore<T>& b) const {
 			return a.total < b.total;
 		}
 	};
 	
+	/* Type: MoveTotalCompare
+	Alias for BasicMoveTotalCompare<delta>.
+	*/
+	typedef BasicMoveTotalCompare<delta> MoveTotalCompare;
+	
+	/* Type: MoveConflictsCompare
+	Alias for BasicMoveConflictsCompare<delta>.
+	*/
+	typedef BasicMoveConflictsCompare<delta> MoveConflictsCompare;
+	
 	/* Struct: SolveReport
 	Report of GLS performance
 	*/
@@ -414,6 +594,8 @@ namespace gls {
 		uint e_minimums;
 		uint s_minimums;
 		
+		uint e_rescales;
+		
 		Score e_start_score;
 		Score s_start_score;
 		
@@ -427,6 +609,11 @@ namespace gls {
 		std::chrono::high_resolution_clock::time_point s_start;
 		uint no_improves;
 		
+		// the stream of the messages, the components of a graph write to their own buffers
+		std::ostream* out;
+		
+		SolveReport() : e_updates(0), out(&std::cout) {}
+		
 		double time_diff(std::chrono::high_resolution_clock::time_point start){
 			std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
 			std::chrono::duration<double, std::milli> time_span = now-start;
@@ -439,6 +626,8 @@ namespace gls {
 			s_iters=0;
 			s_improvements = 0;
 			s_aspirations = 0;
+			s_updates = 0;
+			s_minimums = 0;
 			s_start = std::chrono::system_clock::now();
 			
 			s_start_score.conflicts = 0;
@@ -457,6 +646,7 @@ namespace gls {
 			e_aspirations = 0;
 			e_updates = 0;
 			e_minimums = 0;
+			e_rescales = 0;
 			
 			e_start = std::chrono::system_clock::now();
 			e_start_score = s;
@@ -470,7 +660,7 @@ namespace gls {
 			no_improves = 0;
 			
 			if(DEBUG & DEBUG_MOVES){
-				std::cout << "START," << s_iters << "," << K << std::endl;
+				*out << "START," << s_iters << "," << K << std::endl;
 			}
 		}
 		
@@ -478,7 +668,7 @@ namespace gls {
 			s_K = K;
 			s_iters++;
 			if(DEBUG & DEBUG_SOLUTION){
-				std::cout << "SKIP," << K << std::endl;
+				*out << "SKIP," << K << std::endl;
 			}		
 		}
 		
@@ -502,16 +692,37 @@ namespace gls {
 			}
 			
 			if(DEBUG && DEBUG_EPOCHE){
-				std::cout << e_K << "," << time_diff(e_start) << "," 
+				*out << e_K << "," << time_diff(e_start) << "," 
 							<< e_improvements << "," << e_minimums << "," << e_updates << "," << e_aspirations << ","
 							<< e_start_score.conflicts << "," << e_start_score.guidance << "," << e_start_score.total << ","
 							<< e_final_score.conflicts << "," << e_final_score.guidance << "," << e_final_score.total << std::endl;	
 			}
 		}
 		
+		/*
+		Method: merge
+		Adds the solution of a component of the graph. The solution line shows the updates of the last epoches, so they are added too.
+		*/
+		void merge(const SolveReport &other){
+			s_iters += other.s_iters;
+			s_improvements += other.s_improvements;
+			s_aspirations += other.s_aspirations;
+			s_updates += other.s_updates;
+			s_minimums += other.s_minimums;
+			e_updates += other.e_updates;
+			
+			s_start_score.conflicts += other.s_start_score.conflicts;
+			s_start_score.guidance += other.s_start_score.guidance;
+			s_start_score.total += other.s_start_score.total;
+			
+			s_final_score.conflicts += other.s_final_score.conflicts;
+			s_final_score.guidance += other.s_final_score.guidance;
+			s_final_score.total += other.s_final_score.total;
+		}
+		
 		void finish_solution(){
 			if(DEBUG && DEBUG_SOLUTION){
-				std::cout << s_K << "," << time_diff(s_start) << "," 
+				*out << s_K << "," << time_diff(s_start) << "," 
 							<< s_improvements << "," << s_minimums << "," << e_updates << "," << s_aspirations << ","
 							<< s_start_score.conflicts << "," << s_start_score.guidance << "," << s_start_score.total << ","
 							<< s_final_score.conflicts << "," << s_final_score.guidance << "," << s_final_score.total << std::endl;	
@@ -530,7 +741,14 @@ namespace gls {
 			e_updates++;
 			
 			if(DEBUG & DEBUG_MINIMUM){ 
-				std::cout << "MIN," << e_iters + s_iters << std::endl; 
+				*out << "MIN," << e_iters + s_iters << std::endl; 
+			}
+		}
+		
+		void rescale(){
+			e_rescales++;
+			if(DEBUG & DEBUG_MINIMUM){ 
+				*out << "RESCALE," << e_iters + s_iters << "," << e_rescales << std::endl; 
 			}
 		}
 		
@@ -540,7 +758,8 @@ namespace gls {
 			return check(SolveResolution::LocalMin);
 		}
 		
-		SolveResolution check_move(Move next){
+		template<typename M>
+		SolveResolution check_move(const M &next){
 			if(next.score.total == 0){no_improves++;}
 			else{no_improves=0;}
 			if(DYNAMIC_LAMBDA && e_updates == 0){
@@ -550,9 +769,10 @@ namespace gls {
 			return check(SolveResolution::NotFound);
 		}
 		
-		void report_move(Move next, Score s){
+		template<typename M>
+		void report_move(const M &next, Score s){
 			if(DEBUG & DEBUG_MOVES){
-				std::cout << "MOVE," << e_iters + s_iters 
+				*out << "MOVE," << e_iters + s_iters 
 							<< "," << next.node << "," << next.to << "," 
 							<< s.conflicts << "," << s.guidance << "," << s.total << std::endl;
 			}	
@@ -592,7 +812,7 @@ namespace gls {
 			e_final_score = s;
 			e_improvements++;
 			if(DEBUG & DEBUG_MOVES){
-				std::cout << "IMPROVE," << s_iters << "," << s.conflicts << "," << s.guidance << "," << s.total << std::endl; 
+				*out << "IMPROVE," << s_iters << "," << s.conflicts << "," << s.guidance << "," << s.total << std::endl; 
 			}					
 			//std::cout << "I:" << s.conflicts << ":";
 		}
@@ -617,7 +837,13 @@ namespace gls {
 		Field: index
 		Associate each key with an index.
 		*/ 
-		uint* index;
+		moveid* index;
+		
+		/*
+		Field: capacity
+		Number of allocated entries in index. It only grows, so later builds reuse the array.
+		*/ 
+		moveid capacity;
 		
 		/*
 		Field: elems
@@ -633,13 +859,19 @@ namespace gls {
 		*/
 		Cmp cmp;
 		
-		uint size=0;
+		/*
+		Field: DFS
+		Stack of the heap positions in top_level, kept between the calls.
+		*/
+		std::vector<size_t> DFS;
 		
-		static inline uint parent(uint i) { return i >> 1; }
-		static inline uint left(uint i) { return i << 1; }
-		static inline uint right(uint i) { return (i << 1) + 1; }
+		moveid size=0;
 		
-		void siftUp(uint i){
+		static inline moveid parent(moveid i) { return i >> 1; }
+		static inline moveid left(moveid i) { return i << 1; }
+		static inline moveid right(moveid i) { return (i << 1) + 1; }
+		
+		void siftUp(moveid i){
 			while (i > 1 && cmp(elems[i], elems[parent(i)])) {
 				std::swap(elems[i], elems[parent(i)]);
 				std::swap(index[elems[i].ID], index[elems[parent(i)].ID]);
@@ -649,11 +881,11 @@ namespace gls {
 		
 		// adjusts elems[i] assuming it's been modified to be smaller than its children
 		// runs in O(lgn) time, floats elems[i] down
-		void siftDown(uint i){
-			uint length = elems.size();
+		void siftDown(moveid i){
+			moveid length = elems.size();
 			while (true) {
-				uint l = left(i), r = right(i);
-				uint largest = i;
+				moveid l = left(i), r = right(i);
+				moveid largest = i;
 				
 				if (l < length && cmp(elems[l], elems[largest]))
 					largest = l;
@@ -669,30 +901,32 @@ namespace gls {
 		}
 		public:
 		// construction ------------
-		MovesQueue(){
+		MovesQueue() : index(NULL), capacity(0) {
 			cmp = Cmp();
 		}
 		
 		~MovesQueue(){
-			if(size){
-				delete [] index;
-			}
+			delete [] index;
 		}
 		
-		void prepare(uint S){
+		void prepare(moveid S){
 			size = S;
-			index = new uint[size];
+			if(size > capacity){
+				delete [] index;
+				index = new moveid[size];
+				capacity = size;
+			}
 		}
 		
 		// query ---------------
 		bool empty() const  { return elems.size() <= 1; }
-		uint elements() const { return elems.size() - 1; }
+		moveid elements() const { return elems.size() - 1; }
 		
 		// Insert and extract_top are not supported operations
 		
 		// extraction ----------
 		T top() const       	{ return elems[1]; }
-		T key(uint ID) const 	{ return elems[index[ID]];}
+		T key(moveid ID) const 	{ return elems[index[ID]];}
 		
 		// runs in O(NlgN) time due to siftDown		
 		std::vector<T> extract(){
@@ -720,70 +954,68 @@ namespace gls {
 			return data;
 		}
 		
-		std::vector<T> top_level(const colors &coloring, delta* conflicts, color &K){
-			std::vector<T> moves = std::vector<T>();
+		template<typename F>
+		void top_level(const colors &coloring, F conflicting, std::vector<T> &moves){
+			moves.clear();
 			
 			size_t C, L, R;
 			T mv, best = elems[index[coloring[0]]];
 			
-			std::stack<size_t> DFS = std::stack<size_t>();
-			DFS.push(1);
+			DFS.clear();
+			DFS.push_back(1);
 			while (!DFS.empty()) {
-				C = DFS.top(); 
-				DFS.pop();
+				C = DFS.back(); 
+				DFS.pop_back();
 				if (C >= size){ continue; }
 				mv = elems[C];
 				if (!cmp(mv.score, best.score)){ continue; }
-				const uint sourceID = K * mv.node + coloring[mv.node];
-				
-				if(conflicts[sourceID] > 0 && coloring[mv.node] != mv.to){
+				if(conflicting(mv.node) && coloring[mv.node] != mv.to){
 					if(cmp.weak(mv.score, best.score)){
 						best = mv;
-						moves = std::vector<T>();
+						moves.clear();
 					}
 					
 					if(cmp(mv.score, best.score)){
 						moves.push_back(mv);
 						if(moves.size() > HEAD_CAPACITY){
-							return moves;
+							return;
 						}
 					}
 				}
 				
 				L = MovesQueue::left(C), R = MovesQueue::right(C);
 				if (L < size && cmp(elems[L].score, best.score)){
-					DFS.push(L);
+					DFS.push_back(L);
 				}
 				if(R < size && cmp(elems[R].score, best.score)){
-					DFS.push(R);
+					DFS.push_back(R);
 				}
 			}
-			
-			return moves;
 		}
 		
-		// runs in O(HlgH) time due to DFS
-		std::vector<T> head(const colors &coloring, delta* conflicts, color &K){
+		// runs in O(HlgH) time due to DFS, conflicting(v) tells if the node v has conflicts
+		// the moves are written to moves, so the caller can reuse its vector
+		template<typename F>
+		void head(const colors &coloring, F conflicting, std::vector<T> &moves){
 			if (HEAD_CAPACITY == 1){
-				std::vector<T> moves = std::vector<T>();
+				moves.clear();
 				T mv = top();
-				if(conflicts[K*mv.node + coloring[mv.node]] > 0 && coloring[mv.node] != mv.to){ 
+				if(conflicting(mv.node) && coloring[mv.node] != mv.to){ 
 					moves.push_back(mv);
 				}
-				return moves;
+				return;
 			}
 			
-			return top_level(coloring, conflicts, K);
+			top_level(coloring, conflicting, moves);
 		}
 		
 		// modification ----------
 		// O(n) like constructor for all elements
 		void build(const std::vector<T> &data) {
-			size = data.size();
-			index = new uint[size];
-			std::memset(index, 0, size);
+			prepare(data.size());
+			std::memset(index, 0, size * sizeof(moveid));
 			
-			elems = std::vector<T>();
+			elems.clear();
 			elems.reserve(size+1);
 			elems.push_back(T());
 			
@@ -831,8 +1063,8 @@ namespace gls {
 		}
 		
 		bool correct_index() const {
-			uint skip = 0;
-			for(uint i=0;i<size;++i){
+			moveid skip = 0;
+			for(moveid i=0;i<size;++i){
 				if(index[i] == skip){continue;}
 				//std::cout << i << ": " << index[i] << " ";
 				//Debugger::print_move(elems[index[i]]);
@@ -842,6 +1074,75 @@ namespace gls {
 		}
 	};
 	
+	/*
+	Class: NodeSet
+	Sparse set of nodes with O(1) insert, erase and lookup.
+	The members are kept packed in a vector, so they are iterated in O(size) time instead of O(N).
+	*/
+	class NodeSet {
+		/*
+		Field: members
+		The nodes in the set, in no particular order
+		*/
+		nodes members;
+		/*
+		Field: position
+		The position of every node in members, or NONE if the node is not in the set
+		*/
+		nodes position;
+	
+		static constexpr NodeID NONE = std::numeric_limits<NodeID>::max();
+	
+		public:
+		/*
+		Method: prepare
+		Empties the set for the nodes 0 to n - 1. The memory only grows.
+		*/
+		void prepare(NodeID n){
+			clear();
+			position.resize(n, NONE);
+			members.reserve(n);
+		}
+		/*
+		Method: clear
+		Empties the set in O(size) time.
+		*/
+		void clear(){
+			for(NodeID v: members){ position[v] = NONE; }
+			members.clear();
+		}
+		inline bool contains(NodeID v) const {
+			return position[v] != NONE;
+		}
+		inline void insert(NodeID v){
+			if(contains(v)){ return; }
+			position[v] = members.size();
+			members.push_back(v);
+		}
+		/*
+		Method: erase
+		Moves the last member to the place of v.
+		*/
+		inline void erase(NodeID v){
+			if(!contains(v)){ return; }
+			NodeID last = members.back();
+			members[position[v]] = last;
+			position[last] = position[v];
+			position[v] = NONE;
+			members.pop_back();
+		}
+		/*
+		Method: set
+		Inserts v if member is true, otherwise erases it.
+		*/
+		inline void set(NodeID v, bool member){
+			if(member){ insert(v); } else { erase(v); }
+		}
+		inline size_t size() const { return members.size(); }
+		inline nodes::const_iterator begin() const { return members.begin(); }
+		inline nodes::const_iterator end() const { return members.end(); }
+	};
+	
 	/*
 	Class: ColoringUpperBound
 	This class calculates the upper bound of the chromatic number of a given graph.
@@ -853,93 +1154,155 @@ namespace gls {
 		private:
 		/*
 		Method: get_degrees
-		Calculate the degrees of a graph.
+		Calculate the degrees of a graph on the worker threads.
 		*/
-		static upairs get_degrees(const graph_access &G){
-			upairs degrees = upairs();
-			
+		template<typename Graph>
+		static nodes get_degrees(const Graph &G){
 			NodeID N = G.number_of_nodes();
-			for(NodeID n = 0; n < N; ++n) { 
-				uint degree = G.get_first_invalid_edge(n) - G.get_first_edge(n);
-				degrees.push_back(std::make_pair(n, degree));
-			}
-			
+			nodes degrees = nodes(N);
+			parallel::for_range(N, 4096, [&](size_t begin, size_t end){
+				for(NodeID n = begin; n < end; ++n){
+					degrees[n] = G.get_first_invalid_edge(n) - G.get_first_edge(n);
+				}
+			});
 			return degrees;
 		}
+		
+		/*
+		Method: prefix_bound
+		Returns the number of leading positions i in the descending order of the values, for which the value at i is at least i.
+		The values are counted in buckets instead of sorted, so the time is O(N).
+		*/
+		static uint prefix_bound(const nodes &values){
+			NodeID N = values.size();
+			// at_least[t] is the number of values not smaller than t, values above N are counted as N
+			nodes at_least = nodes(N + 2, 0);
+			for(NodeID value: values){ at_least[std::min(value, N)]++; }
+			for(NodeID t = N; t-- > 0;){ at_least[t] += at_least[t + 1]; }
+			
+			uint result = 0;
+			while(result < N && at_least[result] >= result + 1){ result++; }
+			return result;
+		}
+		
 		public:
 		/*
 		Method: simple
 		Apply Brooks' theorem.
 		*/
-		static uint simple(const graph_access &G){
-			upairs degrees = get_degrees(G);
-			std::sort(degrees.begin(), degrees.end(), upair_comparator);
-			return degrees[0].second + 1;
+		template<typename Graph>
+		static uint simple(const Graph &G){
+			nodes degrees = get_degrees(G);
+			NodeID result = 0;
+			for(NodeID degree: degrees){ result = std::max(result, degree); }
+			return result + 1;
 		}
 		
 		/*
 		Method: theorem2
 		Apply Theorem 2 in the referenced work.
 		*/
-		static uint theorem2(const graph_access &G){
-			upairs degrees = get_degrees(G);
-			std::sort(degrees.begin(), degrees.end(), upair_comparator);
-			
-			uint result = 0; 
-			for(upair d: degrees){
-				if(d.second >= result){ result++; } 
-				else { break; }
-			}
-			
+		template<typename Graph>
+		static uint theorem2(const Graph &G){
+			uint result = prefix_bound(get_degrees(G));
 			return (result > 0) ? result : 1;
 		}
 		
 		/*
 		Method: theorem3
 		Apply Theorem 3 in the referenced work.
+		
+		The rho of a node is the h-index of the degrees of its neighbours: the largest r, such that r neighbours have degree at least r.
+		It is counted in a bucket array per worker, which is cleared after every node, so the time is O(N + M).
 		*/
-		static uint theorem3(const graph_access &G){
-			upairs degrees = get_degrees(G);
-			upairs rhos = upairs();
-			
-			uint N = G.number_of_nodes();
-			uint until, rho;
+		template<typename Graph>
+		static uint theorem3(const Graph &G){
+			nodes degrees = get_degrees(G);
+			NodeID N = G.number_of_nodes();
+			nodes rhos = nodes(N);
+			
+			parallel::for_range(N, 1024, [&](size_t begin, size_t end){
+				nodes count = nodes();
+				for(NodeID v = begin; v < end; ++v){
+					NodeID until = G.get_first_invalid_edge(v) - G.get_first_edge(v);
+					if(count.size() < until + 1){ count.resize(until + 1, 0); }
+					for(NodeID u: G.neighbours(v)){ count[std::min(degrees[u], until)]++; }
+					
+					NodeID rho = until, seen = count[until];
+					while(seen < rho){ seen += count[--rho]; }
+					
+					rhos[v] = rho;
+					std::fill(count.begin(), count.begin() + until + 1, 0);
+				}
+			});
 			
+			uint result = prefix_bound(rhos);
+			return (result > 0) ? result : 1;
+		}
+		
+		/*
+		Method: cores
+		Computes the core numbers and the degeneracy order of G with the bucket algorithm of Batagelj and Zaversnik in O(N + M).
+		The core numbers along the order do not decrease, position is the inverse of order.
+		*/
+		template<typename Graph>
+		static void cores(const Graph &G, nodes &core, nodes &order, nodes &position){
+			NodeID N = G.number_of_nodes();
+			core = get_degrees(G);
+			EdgeID D = 0;
 			for(NodeID v = 0; v < N; ++v){
-				upairs tab = upairs();
-				for(NodeID u: G.neighbours(v)){
-					tab.push_back(degrees[u]);
-				}
-				
-				std::sort(tab.begin(), tab.end(), upair_comparator);
-				
-				rho = 0;
-				until = tab.size();
-				
-				for(NodeID j = 0; j < until; ++j){
-					if(tab[j].second > rho){ rho++; } 
-					else { break; }
-				}
-				
-				rhos.push_back(std::make_pair(v, rho));
+				if(core[v] > D){ D = core[v]; }
 			}
 			
-			std::sort(rhos.begin(), rhos.end(), upair_comparator);
+			// bucket d holds the nodes with current degree d, order[start[d]] is its first node
+			nodes start = nodes(D + 2, 0);
+			for(NodeID v = 0; v < N; ++v){ start[core[v] + 1]++; }
+			for(EdgeID d = 0; d <= D; ++d){ start[d + 1] += start[d]; }
 			
-			uint result = 0; 
-			for(upair d: rhos){
-				if(d.second >= result){ result++; } 
-				else { break; }
+			order = nodes(N);
+			position = nodes(N);
+			nodes next = start;
+			for(NodeID v = 0; v < N; ++v){
+				position[v] = next[core[v]]++;
+				order[position[v]] = v;
 			}
 			
-			return (result > 0) ? result : 1;
+			for(NodeID i = 0; i < N; ++i){
+				NodeID v = order[i];
+				for(NodeID u: G.neighbours(v)){
+					if(core[u] <= core[v]){ continue; }
+					// move u to the front of its bucket and shrink the bucket
+					NodeID du = core[u], w = order[start[du]];
+					if(u != w){
+						std::swap(order[position[u]], order[start[du]]);
+						std::swap(position[u], position[w]);
+					}
+					start[du]++;
+					core[u]--;
+				}
+			}
+		}
+		
+		/*
+		Method: degeneracy
+		Returns the degeneracy + 1. Coloring greedily in reverse degeneracy order (smallest-last) gives every node less colored neighbours than that.
+		*/
+		template<typename Graph>
+		static uint degeneracy(const Graph &G){
+			NodeID N = G.number_of_nodes();
+			if(N == 0){ return 1; }
+			nodes core, order, position;
+			cores(G, core, order, position);
+			// the core numbers do not decrease along the order
+			return core[order[N - 1]] + 1;
 		}
 		
 		/*
 		Method: calculate
 		Interface to combine the methods and the configuration field UPPER_BOUMD
 		*/
-		color calculate(const graph_access &G){
+		template<typename Graph>
+		color calculate(const Graph &G){
 			switch(UPPER_BOUND){
 				case ColoringUpperBoundMethod::Simple:
 					return simple(G);
@@ -947,6 +1310,8 @@ namespace gls {
 					return theorem2(G);
 				case ColoringUpperBoundMethod::Theorem3:
 					return theorem3(G);
+				case ColoringUpperBoundMethod::Degeneracy:
+					return degeneracy(G);
 				default:
 					std::cout << "Coloring upper bound method not implemented" << std::endl;
 					exit(1);
@@ -955,165 +1320,1239 @@ namespace gls {
 	};
 	
 	/*
-	Class: ColoringBuilder
-	Initial coloring builder
-	Supported methods: greedy, bipartite, random
+	Class: GraphReorder
+	Relabels the nodes of a graph to improve the memory locality of the search.
+	Supported orders: reverse Cuthill-McKee, breadth-first, degree sorted
 	*/
-	class ColoringBuilder{
+	class GraphReorder{
 		private:
-		ColoringUpperBound bound;
-		
-		public:
-		ColoringBuilder(){
-			bound = ColoringUpperBound();
-		}
-		
 		/*
-		Method: random
-		Return a random coloring of the graph using at most k colors.
+		Method: breadth_first
+		Return the breadth-first order of all components, every one started from an unvisited node with minimal degree.
+		If by_degree is set, the neighbours of a node are visited in ascending order of their degrees.
 		*/
-		static colors random(const graph_access &G, color k){
-			const NodeID N = G.number_of_nodes();
-			colors result = colors();
-			for(NodeID i = 0; i < N; ++i){
-				result.push_back(rand() % k);
+		template<typename Graph>
+		static nodes breadth_first(const Graph &G, bool by_degree){
+			NodeID N = G.number_of_nodes();
+			nodes order = degree_sorted(G);
+			std::reverse(order.begin(), order.end());
+			
+			nodes result = nodes();
+			result.reserve(N);
+			std::vector<bool> visited(N, false);
+			upairs next = upairs();
+			
+			for(NodeID s: order){
+				if(visited[s]){ continue; }
+				visited[s] = true;
+				
+				NodeID head = result.size();
+				result.push_back(s);
+				while(head < result.size()){
+					NodeID v = result[head++];
+					next.clear();
+					for(NodeID u: G.neighbours(v)){
+						if(visited[u]){ continue; }
+						visited[u] = true;
+						next.push_back(std::make_pair(u, G.getNodeDegree(u)));
+					}
+					if(by_degree){
+						std::sort(next.begin(), next.end(), [](const upair &a, const upair &b){
+							return a.second < b.second;
+						});
+					}
+					for(upair u: next){ result.push_back(u.first); }
+				}
 			}
+			
 			return result;
 		}
 		
+		public:
 		/*
-		Method: bipartite
-		Return a coloring of the graph using at most 2 colors by applying a modfied DFS.
-		Visit: <http://www.techiedelight.com/determine-given-graph-bipartite-graph-using-dfs/>
+		Method: degree_sorted
+		Return the nodes sorted by their degrees in descending order, using a counting sort.
 		*/
-		static colors bipartite(const graph_access &G){
+		template<typename Graph>
+		static nodes degree_sorted(const Graph &G){
 			NodeID N = G.number_of_nodes();
-			int next;
-			int* bi = new int[N];
-			for(NodeID s = 0; s < N; ++s){ bi[s] = 0; }
-		
-			std::stack<std::pair<NodeID, int>> S = std::stack<std::pair<NodeID, int>>();
-			for(NodeID s = 0; s < N; ++s){
-				if(bi[s] > 0){ continue; }
-				S.push(std::make_pair(s, 1));
-				while (S.size() > 0){
-					std::pair<NodeID, int> m = S.top();
-					S.pop();
-					if(bi[m.first] > 0){continue;}
-					bi[m.first] = m.second;
-					next = (m.second == 1) ? 2 : 1;
-					for(NodeID v: G.neighbours(m.first)){
-						if(bi[v] > 0){continue;}
-						S.push(std::make_pair(v, next));
-					}
-				}
+			EdgeID D = 0;
+			for(NodeID v = 0; v < N; ++v){
+				if(G.getNodeDegree(v) > D){ D = G.getNodeDegree(v); }
 			}
 			
-			colors result = colors();
-			for(NodeID s = 0; s < N; ++s){
-				result.push_back(bi[s] - 1);
+			nodes start = nodes(D + 2, 0);
+			for(NodeID v = 0; v < N; ++v){ start[D - G.getNodeDegree(v) + 1]++; }
+			for(EdgeID d = 0; d <= D; ++d){ start[d + 1] += start[d]; }
+			
+			nodes result = nodes(N);
+			for(NodeID v = 0; v < N; ++v){
+				result[start[D - G.getNodeDegree(v)]++] = v;
 			}
+			return result;
+		}
 		
-			delete [] bi;
-		
+		/*
+		Method: cuthill_mckee
+		Return the reverse Cuthill-McKee order.
+		*/
+		template<typename Graph>
+		static nodes cuthill_mckee(const Graph &G){
+			nodes result = breadth_first(G, true);
+			std::reverse(result.begin(), result.end());
 			return result;
 		}
 		
 		/*
-		Method: greedy
-		Return a coloring of the graph using a simple greedy strategy.
-		Visit: <http://www.geeksforgeeks.org/graph-coloring-set-2-greedy-algorithm/>
+		Method: relabel
+		Build the graph H, in which node i is the node order[i] of G. The adjacencies of H are sorted.
 		*/
-		static colors greedy(const graph_access &G){
+		template<typename Graph>
+		static void relabel(const Graph &G, const nodes &order, graph_access &H){
 			NodeID N = G.number_of_nodes();
+			nodes label = nodes(N);
+			for(NodeID i = 0; i < N; ++i){ label[order[i]] = i; }
 			
-			color null = -1;
-			color result[N];
-			bool available[N];
-			
-			for (NodeID v = 0; v < N; ++v){ 
-				available[v] = false;
-				result[v] = -1; 
-			}
-			
-			result[0] = 0;
-	
-			for (NodeID v = 1; v < N; v++){
-				for (NodeID u : G.neighbours(v)) {
-					if(result[u] != null){
-						available[result[u]] = true;
-					}
-				}
-				
-				NodeID cr;
-				for (cr = 0; cr < N; ++cr){
-					if (available[cr] == false){
-						break;
-					}
-				}
-				
-				result[v] = cr;
-				
-				for (NodeID u : G.neighbours(v)) {
-					if(result[u] != null){
-						available[result[u]] = false;
-					}
+			std::vector<EdgeID> first = std::vector<EdgeID>(N + 1, 0);
+			std::vector<NodeID> targets = std::vector<NodeID>();
+			targets.reserve(G.number_of_edges());
+			for(NodeID i = 0; i < N; ++i){
+				for(NodeID u: G.neighbours(order[i])){
+					targets.push_back(label[u]);
 				}
+				std::sort(targets.begin() + first[i], targets.end());
+				first[i + 1] = targets.size();
 			}
 			
-			colors coloring = colors(); 
-			for (NodeID v = 0; v < N; ++v){
-				coloring.push_back(result[v]);
-			}
-			
-			return coloring;
+			H.build_from_csr(first, targets);
 		}
 		
-		colors build(const graph_access &G){
-			switch(BUILD_STRATEGY){
-				case BuildStrategy::RandomStart:
-					return random(G, bound.calculate(G));
-				case BuildStrategy::Greedy:
-					return greedy(G);
-				case BuildStrategy::Bipartite:
-					return bipartite(G);
+		/*
+		Method: calculate
+		Interface to combine the methods and the configuration field REORDER.
+		Returns the new order of the nodes: the i-th node of the relabeled graph is the node order[i].
+		*/
+		template<typename Graph>
+		static nodes calculate(const Graph &G){
+			switch(REORDER){
+				case ReorderStrategy::CuthillMcKee:
+					return cuthill_mckee(G);
+				case ReorderStrategy::BreadthFirst:
+					return breadth_first(G, false);
+				case ReorderStrategy::DegreeSorted:
+					return degree_sorted(G);
 				default:
-					std::cout << "Not supported build method" << std::endl;
+					std::cout << "Reorder strategy not implemented" << std::endl;
 					exit(1);
 			}
 		}
 	};
 	
 	/*
-	Class: GuidedLocalSearch
-	Implementation of the Guided Local Search Algorithm
+	Class: ColoringLowerBound
+	This class calculates a lower bound of the chromatic number of a given graph.
 	
-	Visit: <http://www.cleveralgorithms.com/nature-inspired/stochastic/guided_local_search.html>
+	The nodes of a clique need different colors, so the size of any found clique is a bound.
+	The cliques are built greedily from the nodes with the highest degrees and enlarged by a local search with add and swap moves.
 	
-	Improvements that are added:
-    
-	- Dynamic optimization of the restricted one exchange neighbourhood
-    - Aspiration movements
-	- Optional external reset of the weights
-	- Execution timeout
+	The spectral bound is the Hoffman bound, it is based on the following work:
+	<https://doi.org/10.1016/B978-0-12-324050-4.50008-8>
 	*/
-	class GuidedLocalSearch {
-	private:
+	class ColoringLowerBound{
+		private:
 		/*
-		 Field: N
-		 Number of nodes
-		 */
-		uint N;
+		Method: greedy
+		Builds a clique from the node s. The candidates are the nodes adjacent to the whole clique,
+		the one with the most candidate neighbours is added, until there are no candidates.
+		*/
+		template<typename Graph>
+		static nodes greedy(const Graph &G, NodeID s){
+			NodeID N = G.number_of_nodes();
+			nodes clique = nodes(1, s);
+			nodes mark = nodes(N, N);
+			nodes candidates = nodes();
+			std::vector<bool> candidate = std::vector<bool>(N, false);
+			for(NodeID u: G.neighbours(s)){
+				if(u != s && !candidate[u]){
+					candidate[u] = true;
+					candidates.push_back(u);
+				}
+			}
+			
+			while(!candidates.empty()){
+				NodeID v = candidates[0], most = 0;
+				for(NodeID u: candidates){
+					NodeID common = 0;
+					for(NodeID w: G.neighbours(u)){
+						if(candidate[w]){ common++; }
+					}
+					if(common > most){
+						v = u;
+						most = common;
+					}
+				}
+				clique.push_back(v);
+				
+				for(NodeID u: G.neighbours(v)){ mark[u] = v; }
+				nodes next = nodes();
+				for(NodeID u: candidates){
+					if(u != v && mark[u] == v){ next.push_back(u); }
+					else { candidate[u] = false; }
+				}
+				candidates.swap(next);
+			}
+			return clique;
+		}
+		
+		/*
+		Method: greedy
+		Builds a clique from the node s on the bitsets of a dense graph. The candidate with the most candidate neighbours is added,
+		counted with a popcount of its row and the candidate set.
+		*/
+		static nodes greedy(const dense_graph &G, NodeID s){
+			size_t W = G.words();
+			nodes clique = nodes(1, s);
+			std::vector<uint64_t> candidates = std::vector<uint64_t>(G.row(s), G.row(s) + W);
+			candidates[s >> 6] &= ~(uint64_t(1) << (s & 63));
+			
+			while(true){
+				NodeID v = G.number_of_nodes();
+				size_t most = 0;
+				for(size_t w = 0; w < W; ++w){
+					for(uint64_t bits = candidates[w]; bits; bits &= bits - 1){
+						NodeID u = w * 64 + popcount::lowest(bits);
+						size_t common = G.count_neighbours(u, candidates.data());
+						if(v == G.number_of_nodes() || common > most){
+							v = u;
+							most = common;
+						}
+					}
+				}
+				if(v == G.number_of_nodes()){ break; }
+				
+				clique.push_back(v);
+				const uint64_t* row = G.row(v);
+				for(size_t w = 0; w < W; ++w){ candidates[w] &= row[w]; }
+				candidates[v >> 6] &= ~(uint64_t(1) << (v & 63));
+			}
+			return clique;
+		}
+		
+		/*
+		Method: improve
+		Local search on a clique: a node adjacent to all members is added, otherwise a node adjacent to all but one member replaces it.
+		A replaced member may not return for a number of steps equal to the clique size. Returns the size of the biggest clique seen.
+		*/
+		template<typename Graph>
+		static color improve(const Graph &G, const nodes &clique, nodes &mark, nodes &count, nodes &tabu){
+			NodeID N = G.number_of_nodes();
+			std::vector<bool> in = std::vector<bool>(N, false);
+			nodes members = nodes();
+			nodes touched = nodes();
+			
+			auto add = [&](NodeID v){
+				in[v] = true;
+				members.push_back(v);
+				for(NodeID u: G.neighbours(v)){
+					if(count[u]++ == 0){ touched.push_back(u); }
+				}
+			};
+			auto remove = [&](NodeID v){
+				in[v] = false;
+				members.erase(std::find(members.begin(), members.end(), v));
+				for(NodeID u: G.neighbours(v)){ count[u]--; }
+			};
+			
+			for(NodeID v: clique){ add(v); }
+			nodes best = members;
+			
+			ulong steps = 100 * (ulong) members.size() + 100;
+			for(ulong step = 1; step <= steps; ++step){
+				NodeID size = members.size(), addable = N, swappable = N;
+				for(NodeID u: touched){
+					if(in[u] || tabu[u] >= step){ continue; }
+					if(count[u] == size){ addable = u; break; }
+					if(count[u] + 1 == size && swappable == N){ swappable = u; }
+				}
+				
+				if(addable != N){
+					add(addable);
+					if(members.size() > best.size()){ best = members; }
+				} else if(swappable != N){
+					for(NodeID u: G.neighbours(swappable)){ mark[u] = swappable; }
+					NodeID out = N;
+					for(NodeID m: members){
+						if(mark[m] != swappable){ out = m; break; }
+					}
+					remove(out);
+					tabu[out] = step + size;
+					add(swappable);
+				} else {
+					break;
+				}
+			}
+			
+			for(NodeID u: touched){ count[u] = 0; tabu[u] = 0; }
+			for(NodeID v: clique){ tabu[v] = 0; }
+			
+			// the counts assume a simple graph, so the result is checked against the adjacencies
+			return is_clique(G, best) ? best.size() : clique.size();
+		}
+		
+		/*
+		Method: is_clique
+		Checks, if every two nodes of a set are adjacent.
+		*/
+		template<typename Graph>
+		static bool is_clique(const Graph &G, const nodes &set){
+			NodeID N = G.number_of_nodes();
+			std::vector<bool> in = std::vector<bool>(N, false);
+			for(NodeID v: set){ in[v] = true; }
+			nodes seen = nodes(N, N);
+			for(NodeID v: set){
+				NodeID adjacent = 0;
+				for(NodeID u: G.neighbours(v)){
+					if(in[u] && u != v && seen[u] != v){
+						seen[u] = v;
+						adjacent++;
+					}
+				}
+				if(adjacent + 1 != set.size()){ return false; }
+			}
+			return true;
+		}
+		
+		/*
+		Method: eigenvalues_below
+		Sturm count: the number of eigenvalues of the symmetric tridiagonal matrix with diagonal alpha and off-diagonal beta, which are smaller than x.
+		*/
+		static size_t eigenvalues_below(const std::vector<double> &alpha, const std::vector<double> &beta, double x){
+			size_t count = 0;
+			double d = 1;
+			for(size_t i = 0; i < alpha.size(); ++i){
+				d = alpha[i] - x - ((i > 0) ? beta[i - 1] * beta[i - 1] / d : 0.0);
+				if(d == 0){ d = -1e-300; }
+				if(d < 0){ count++; }
+			}
+			return count;
+		}
+		
+		/*
+		Method: extreme_eigenvalue
+		Finds the smallest or the largest eigenvalue of a symmetric tridiagonal matrix by bisection inside the Gershgorin interval.
+		*/
+		static double extreme_eigenvalue(const std::vector<double> &alpha, const std::vector<double> &beta, bool smallest){
+			size_t m = alpha.size();
+			double lo = alpha[0], hi = alpha[0];
+			for(size_t i = 0; i < m; ++i){
+				double radius = ((i > 0) ? std::fabs(beta[i - 1]) : 0.0) + ((i + 1 < m) ? std::fabs(beta[i]) : 0.0);
+				lo = std::min(lo, alpha[i] - radius);
+				hi = std::max(hi, alpha[i] + radius);
+			}
+			
+			size_t target = smallest ? 1 : m;
+			for(int i = 0; i < 100 && hi - lo > 1e-12 * std::max(1.0, std::fabs(lo) + std::fabs(hi)); ++i){
+				double mid = (lo + hi) / 2;
+				if(eigenvalues_below(alpha, beta, mid) >= target){ hi = mid; }
+				else { lo = mid; }
+			}
+			return (lo + hi) / 2;
+		}
+		
+		public:
+		/*
+		Method: spectral
+		Returns the Hoffman bound 1 - lambda_max / lambda_min of the adjacency eigenvalues.
+		
+		The extreme eigenvalues are estimated by a matrix-free Lanczos iteration. The products with the adjacency matrix run on the worker threads.
+		The iteration stops, when both extreme Ritz values are stable or when the Krylov space is invariant. Without convergence in SPECTRAL_STEPS steps no bound is returned.
+		*/
+		template<typename Graph>
+		static color spectral(const Graph &G){
+			NodeID N = G.number_of_nodes();
+			if(N == 0){ return 0; }
+			if(G.number_of_edges() == 0){ return 1; }
+			
+			// start from a perturbed all-ones vector, so it is not orthogonal to the Perron vector of a component
+			std::vector<double> q = std::vector<double>(N), previous = std::vector<double>(N, 0.0), w = std::vector<double>(N);
+			double norm = 0;
+			for(NodeID v = 0; v < N; ++v){
+				q[v] = 1.0 + 0.5 * double((v * 2654435761u) % 1000) / 1000.0;
+				norm += q[v] * q[v];
+			}
+			norm = std::sqrt(norm);
+			for(NodeID v = 0; v < N; ++v){ q[v] /= norm; }
+			
+			std::vector<double> alpha = std::vector<double>(), beta = std::vector<double>();
+			double lambda_max = 0, lambda_min = 0;
+			bool converged = false;
+			uint steps = std::min<uint>(SPECTRAL_STEPS, N);
+			for(uint j = 0; j < steps; ++j){
+				double b = (j > 0) ? beta[j - 1] : 0.0;
+				parallel::for_range(N, 4096, [&](size_t begin, size_t end){
+					for(NodeID v = begin; v < end; ++v){
+						double sum = 0;
+						for(NodeID u: G.neighbours(v)){ sum += q[u]; }
+						w[v] = sum - b * previous[v];
+					}
+				});
+				
+				double a = 0;
+				for(NodeID v = 0; v < N; ++v){ a += w[v] * q[v]; }
+				double next = 0;
+				for(NodeID v = 0; v < N; ++v){
+					w[v] -= a * q[v];
+					next += w[v] * w[v];
+				}
+				next = std::sqrt(next);
+				alpha.push_back(a);
+				
+				bool invariant = next < 1e-10;
+				if(invariant || j + 1 == steps || (j + 1) % 5 == 0){
+					double high = extreme_eigenvalue(alpha, beta, false), low = extreme_eigenvalue(alpha, beta, true);
+					converged = invariant || (j >= 10 && std::fabs(high - lambda_max) <= 1e-6 * std::fabs(high) && std::fabs(low - lambda_min) <= 1e-6 * std::fabs(low));
+					lambda_max = high;
+					lambda_min = low;
+					if(converged){ break; }
+				}
+				
+				beta.push_back(next);
+				for(NodeID v = 0; v < N; ++v){
+					previous[v] = q[v];
+					q[v] = w[v] / next;
+				}
+			}
+			
+			// the Ritz values lie inside the spectrum, an unconverged lambda_min would overestimate the bound
+			if(!converged){ return 0; }
+			if(lambda_min >= 0){ return 1; }
+			// the small tolerance keeps rounding errors from adding a color to an integral bound
+			double bound = 1.0 - lambda_max / lambda_min;
+			return (color) std::ceil(bound - 1e-6);
+		}
+		
+		/*
+		Method: clique
+		Returns the size of the biggest clique found from the CLIQUE_STARTS nodes with the highest degrees.
+		*/
+		template<typename Graph>
+		static color clique(const Graph &G){
+			NodeID N = G.number_of_nodes();
+			if(N == 0){ return 0; }
+			
+			nodes order = GraphReorder::degree_sorted(G);
+			nodes mark = nodes(N, N), count = nodes(N, 0), tabu = nodes(N, 0);
+			color best = 1;
+			NodeID starts = std::min<NodeID>(N, CLIQUE_STARTS);
+			for(NodeID i = 0; i < starts; ++i){
+				NodeID s = order[i];
+				// a clique through s has at most degree + 1 nodes
+				if(G.getNodeDegree(s) + 1 <= best){ break; }
+				nodes found = greedy(G, s);
+				color size = improve(G, found, mark, count, tabu);
+				if(size > best){ best = size; }
+			}
+			return best;
+		}
+	};
+	
+	/*
+	Class: GraphReduction
+	Removes dominated nodes: a node v is dominated by a node w, which is not its neighbour, if every neighbour of v is a neighbour of w.
+	Any coloring of the graph without v stays correct, when v gets the color of w, so the chromatic number does not change.
+	
+	False twins, the nodes with equal neighbourhoods, are found first by hashing the neighbourhoods.
+	The remaining dominated nodes are removed one by one, every check is made on the graph left by the previous removals.
+	Only a removal can make its neighbours dominated, so after the first check of every node only the neighbours of the removed nodes are checked again.
+	The coloring is expanded in reverse order of the removals.
+	*/
+	class GraphReduction{
+		private:
+		/*
+		Field: label
+		The node of the reduced graph for every node of the graph, or N for a removed node
+		*/
+		nodes label;
+		/*
+		Field: kept
+		The node of the graph for every node of the reduced graph
+		*/
+		nodes kept;
+		/*
+		Field: removed
+		Pairs of a removed node and the node dominating it, in the order of the removals
+		*/
+		upairs removed;
+		
+		/*
+		Method: twins
+		Removes all but the first node of every class of false twins. The hash of a neighbourhood is the sum of the mixed neighbour IDs,
+		so it does not depend on the order of the adjacency. Nodes with equal hash and degree are compared by marking the neighbours.
+		*/
+		template<typename Graph>
+		void twins(const Graph &G, std::vector<bool> &alive){
+			NodeID N = G.number_of_nodes();
+			std::vector<std::pair<uint64_t, NodeID>> hashes = std::vector<std::pair<uint64_t, NodeID>>(N);
+			for(NodeID v = 0; v < N; ++v){
+				uint64_t hash = mix(G.getNodeDegree(v));
+				for(NodeID u: G.neighbours(v)){ hash += mix(u); }
+				hashes[v] = std::make_pair(hash, v);
+			}
+			std::sort(hashes.begin(), hashes.end());
+			
+			nodes mark = nodes(N, N);
+			for(NodeID i = 0, j; i < N; i = j){
+				for(j = i + 1; j < N && hashes[j].first == hashes[i].first; ++j){}
+				
+				NodeID w = hashes[i].second;
+				for(NodeID u: G.neighbours(w)){ mark[u] = w; }
+				for(NodeID t = i + 1; t < j; ++t){
+					NodeID v = hashes[t].second;
+					if(G.getNodeDegree(v) != G.getNodeDegree(w) || mark[v] == w){ continue; }
+					
+					bool equal = true;
+					for(NodeID u: G.neighbours(v)){
+						if(mark[u] != w){ equal = false; break; }
+					}
+					if(equal){
+						alive[v] = false;
+						removed.push_back(std::make_pair(v, w));
+					}
+				}
+			}
+		}
+		
+		/*
+		Method: dominated
+		Removes dominated nodes until there are none. The dominators of v are searched among the neighbours of its neighbour with the smallest degree.
+		The test of a candidate w stops as soon as the unvisited neighbours of w can not cover the rest of the neighbours of v.
+		A check takes O(deg(v) + deg(w)) time per candidate in the worst case, and there are at most N + 2M checks.
+		*/
+		template<typename Graph>
+		void dominated(const Graph &G, std::vector<bool> &alive){
+			NodeID N = G.number_of_nodes();
+			nodes degree = nodes(N, 0);
+			NodeID count = 0;
+			for(NodeID v = 0; v < N; ++v){
+				if(!alive[v]){ continue; }
+				count++;
+				for(NodeID u: G.neighbours(v)){
+					if(alive[u]){ degree[v]++; }
+				}
+			}
+			
+			nodes mark = nodes(N, N);
+			// the nodes are only removed, so the lowest alive node only moves forward and the isolated nodes take O(N) time together
+			NodeID lowest = 0;
+			// every node is checked once, then the neighbours of the removed nodes again
+			std::queue<NodeID> pending = std::queue<NodeID>();
+			std::vector<bool> queued = std::vector<bool>(N, true);
+			for(NodeID v = 0; v < N; ++v){ pending.push(v); }
+			while(!pending.empty() && count > 1){
+				NodeID v = pending.front();
+				pending.pop();
+				queued[v] = false;
+				if(!alive[v]){ continue; }
+				
+				NodeID dominator = N;
+				if(degree[v] == 0){
+					// an isolated node is dominated by any other node, the lowest alive one or the next one after v
+					while(!alive[lowest]){ lowest++; }
+					dominator = lowest;
+					if(dominator == v){
+						for(dominator = v + 1; dominator < N && !alive[dominator]; ++dominator){}
+					}
+				} else {
+					NodeID smallest = N;
+					for(NodeID u: G.neighbours(v)){
+						if(!alive[u]){ continue; }
+						mark[u] = v;
+						if(smallest == N || degree[u] < degree[smallest]){ smallest = u; }
+					}
+					
+					for(NodeID w: G.neighbours(smallest)){
+						if(!alive[w] || w == v || mark[w] == v || degree[w] < degree[v]){ continue; }
+						// w misses a neighbour of v, as soon as more than degree[w] - degree[v] of its neighbours are not marked
+						NodeID misses = degree[w] - degree[v] + 1;
+						for(NodeID x: G.neighbours(w)){
+							if(alive[x] && mark[x] != v && --misses == 0){ break; }
+						}
+						if(misses > 0){
+							dominator = w;
+							break;
+						}
+					}
+				}
+				
+				if(dominator == N){ continue; }
+				alive[v] = false;
+				count--;
+				for(NodeID u: G.neighbours(v)){
+					if(!alive[u]){ continue; }
+					degree[u]--;
+					if(!queued[u]){
+						queued[u] = true;
+						pending.push(u);
+					}
+				}
+				removed.push_back(std::make_pair(v, dominator));
+			}
+		}
+		
+		public:
+		/*
+		Method: reduce
+		Builds the reduced graph H of G. The adjacencies of H keep the order of G.
+		*/
+		template<typename Graph>
+		void reduce(const Graph &G, graph_access &H){
+			NodeID N = G.number_of_nodes();
+			removed = upairs();
+			std::vector<bool> alive = std::vector<bool>(N, true);
+			twins(G, alive);
+			dominated(G, alive);
+			
+			label = nodes(N, N);
+			kept = nodes();
+			for(NodeID v = 0; v < N; ++v){
+				if(alive[v]){
+					label[v] = kept.size();
+					kept.push_back(v);
+				}
+			}
+			
+			std::vector<EdgeID> first = std::vector<EdgeID>(kept.size() + 1, 0);
+			std::vector<NodeID> targets = std::vector<NodeID>();
+			for(NodeID i = 0; i < kept.size(); ++i){
+				for(NodeID u: G.neighbours(kept[i])){
+					if(label[u] != N){ targets.push_back(label[u]); }
+				}
+				first[i + 1] = targets.size();
+			}
+			H.build_from_csr(first, targets);
+		}
+		
+		/*
+		Method: restrict
+		Returns the coloring of the reduced graph, which a coloring of the graph induces.
+		*/
+		colors restrict(const colors &coloring) const {
+			colors result = colors(kept.size());
+			for(NodeID i = 0; i < kept.size(); ++i){ result[i] = coloring[kept[i]]; }
+			return result;
+		}
+		
+		/*
+		Method: expand
+		Returns the coloring of the graph from a coloring of the reduced graph. The removed nodes get the colors of their dominators.
+		*/
+		colors expand(const colors &coloring) const {
+			colors result = colors(label.size(), 0);
+			for(NodeID i = 0; i < kept.size(); ++i){ result[kept[i]] = coloring[i]; }
+			for(upairs::const_reverse_iterator it = removed.rbegin(); it != removed.rend(); ++it){
+				result[it->first] = result[it->second];
+			}
+			return result;
+		}
+		
+		/*
+		Method: removed_nodes
+		Returns the number of the removed nodes.
+		*/
+		NodeID removed_nodes() const {
+			return removed.size();
+		}
+	};
+	
+	/*
+	Class: IndependentSetExtraction
+	Extracts independent sets with the Recursive Largest First strategy of Leighton, until only a given number of nodes is left.
+	Every extracted set is one color class, the search has to color only the residual graph with the remaining colors.
+	
+	This class is based on the following work:
+	<https://doi.org/10.6028/jres.084.024>
+	
+	A set starts from the node with the most uncolored neighbours. Then the candidate with the most neighbours,
+	which are blocked by the set, is added, and on ties the one with the least candidate neighbours. 
+	The candidates are kept in a binary heap, which gets a new entry for every changed key, the outdated entries are skipped.
+	*/
+	class IndependentSetExtraction{
+		private:
+		/*
+		Field: label
+		The color class of every extracted node, or the node of the residual graph plus the number of classes for a kept node
+		*/
+		nodes label;
+		/*
+		Field: kept
+		The node of the graph for every node of the residual graph
+		*/
+		nodes kept;
+		/*
+		Field: sets
+		The number of the extracted independent sets
+		*/
+		color sets;
+		
+		public:
+		IndependentSetExtraction() : sets(0) {}
+		
+		/*
+		Method: extract
+		Extracts independent sets from G, until at most residual nodes are left, and builds the residual graph H on them.
+		*/
+		template<typename Graph>
+		void extract(const Graph &G, graph_access &H, NodeID residual){
+			NodeID N = G.number_of_nodes();
+			const NodeID uncolored = N, candidate = N + 1, blocked = N + 2;
+			nodes state = nodes(N, uncolored), degree = nodes(N), blocking = nodes(N), free = nodes(N);
+			for(NodeID v = 0; v < N; ++v){ degree[v] = G.getNodeDegree(v); }
+			
+			// the heap entries are (blocked neighbours, N - candidate neighbours, node)
+			typedef std::pair<upair, NodeID> entry;
+			std::vector<entry> heap = std::vector<entry>();
+			nodes members = nodes();
+			
+			NodeID left = N;
+			sets = 0;
+			while(left > residual){
+				heap.clear();
+				NodeID start = N;
+				for(NodeID v = 0; v < N; ++v){
+					if(state[v] != uncolored){ continue; }
+					state[v] = candidate;
+					blocking[v] = 0;
+					free[v] = degree[v];
+					heap.push_back(std::make_pair(std::make_pair(0, N - free[v]), v));
+					if(start == N || degree[v] > degree[start]){ start = v; }
+				}
+				std::make_heap(heap.begin(), heap.end());
+				
+				members.clear();
+				NodeID v = start;
+				while(true){
+					state[v] = sets;
+					members.push_back(v);
+					for(NodeID x: G.neighbours(v)){
+						if(state[x] != candidate){ continue; }
+						state[x] = blocked;
+						for(NodeID y: G.neighbours(x)){
+							if(state[y] != candidate){ continue; }
+							blocking[y]++;
+							free[y]--;
+							heap.push_back(std::make_pair(std::make_pair(blocking[y], N - free[y]), y));
+							std::push_heap(heap.begin(), heap.end());
+						}
+					}
+					
+					v = N;
+					while(!heap.empty()){
+						entry top = heap.front();
+						std::pop_heap(heap.begin(), heap.end());
+						heap.pop_back();
+						NodeID u = top.second;
+						if(state[u] == candidate && top.first.first == blocking[u] && top.first.second == N - free[u]){
+							v = u;
+							break;
+						}
+					}
+					if(v == N){ break; }
+				}
+				
+				// the blocked nodes stay for the next sets, the members are colored
+				for(NodeID u = 0; u < N; ++u){
+					if(state[u] == blocked || state[u] == candidate){ state[u] = uncolored; }
+				}
+				for(NodeID m: members){
+					for(NodeID u: G.neighbours(m)){ degree[u]--; }
+				}
+				left -= members.size();
+				sets++;
+			}
+			
+			label = nodes(N);
+			kept = nodes();
+			for(NodeID v = 0; v < N; ++v){
+				if(state[v] == uncolored){
+					label[v] = sets + kept.size();
+					kept.push_back(v);
+				} else {
+					label[v] = state[v];
+				}
+			}
+			
+			std::vector<EdgeID> first = std::vector<EdgeID>(kept.size() + 1, 0);
+			std::vector<NodeID> targets = std::vector<NodeID>();
+			for(NodeID i = 0; i < kept.size(); ++i){
+				for(NodeID u: G.neighbours(kept[i])){
+					if(label[u] >= sets){ targets.push_back(label[u] - sets); }
+				}
+				first[i + 1] = targets.size();
+			}
+			H.build_from_csr(first, targets);
+		}
+		
+		/*
+		Method: restrict
+		Returns the coloring of the residual graph from a coloring of the graph. The used colors are renumbered from zero, so a correct coloring stays correct.
+		*/
+		colors restrict(const colors &coloring) const {
+			colors result = colors(kept.size());
+			color k = 0;
+			for(NodeID v: kept){ k = std::max(k, coloring[v] + 1); }
+			std::vector<color> renumber = std::vector<color>(k, 0);
+			color next = 0;
+			for(NodeID i = 0; i < kept.size(); ++i){
+				color c = coloring[kept[i]];
+				if(renumber[c] == 0){ renumber[c] = ++next; }
+				result[i] = renumber[c] - 1;
+			}
+			return result;
+		}
+		
+		/*
+		Method: expand
+		Returns the coloring of the graph from a coloring of the residual graph. The extracted sets keep the first colors.
+		*/
+		colors expand(const colors &coloring) const {
+			colors result = colors(label.size());
+			for(NodeID v = 0; v < label.size(); ++v){
+				result[v] = (label[v] < sets) ? label[v] : sets + coloring[label[v] - sets];
+			}
+			return result;
+		}
+		
+		/*
+		Method: extracted_sets
+		Returns the number of the extracted independent sets.
+		*/
+		color extracted_sets() const {
+			return sets;
+		}
+	};
+	
+	/*
+	Class: ColoringBuilder
+	Initial coloring builder
+	Supported methods: greedy in natural, largest-first, smallest-last or incidence-degree order, DSATUR, bipartite, random
+	*/
+	class ColoringBuilder{
+		private:
+		ColoringUpperBound bound;
+		std::mt19937 engine;
+		
+		public:
+		ColoringBuilder() : engine(SEED) {
+			bound = ColoringUpperBound();
+		}
+		
+		/*
+		Method: random
+		Return a random coloring of the graph using at most k colors, drawn from the engine.
+		*/
+		template<typename Graph>
+		static colors random(const Graph &G, color k, std::mt19937 &engine){
+			const NodeID N = G.number_of_nodes();
+			colors result = colors();
+			for(NodeID i = 0; i < N; ++i){
+				result.push_back(engine() % k);
+			}
+			return result;
+		}
+		
+		/*
+		Method: bipartite
+		Return a coloring of the graph using at most 2 colors by applying a modfied DFS.
+		Visit: <http://www.techiedelight.com/determine-given-graph-bipartite-graph-using-dfs/>
+		*/
+		template<typename Graph>
+		static colors bipartite(const Graph &G){
+			NodeID N = G.number_of_nodes();
+			int next;
+			int* bi = new int[N];
+			for(NodeID s = 0; s < N; ++s){ bi[s] = 0; }
+		
+			std::stack<std::pair<NodeID, int>> S = std::stack<std::pair<NodeID, int>>();
+			for(NodeID s = 0; s < N; ++s){
+				if(bi[s] > 0){ continue; }
+				S.push(std::make_pair(s, 1));
+				while (S.size() > 0){
+					std::pair<NodeID, int> m = S.top();
+					S.pop();
+					if(bi[m.first] > 0){continue;}
+					bi[m.first] = m.second;
+					next = (m.second == 1) ? 2 : 1;
+					for(NodeID v: G.neighbours(m.first)){
+						if(bi[v] > 0){continue;}
+						S.push(std::make_pair(v, next));
+					}
+				}
+			}
+			
+			colors result = colors();
+			for(NodeID s = 0; s < N; ++s){
+				result.push_back(bi[s] - 1);
+			}
+		
+			delete [] bi;
+		
+			return result;
+		}
+		
+		/*
+		Method: greedy
+		Return a coloring of the graph, which colors the nodes in the given order, each with the smallest color not used by its neighbours.
+		Visit: <http://www.geeksforgeeks.org/graph-coloring-set-2-greedy-algorithm/>
+		
+		The neighbour colors are marked in a bitset, the smallest free color of a node v is below its degree + 1,
+		so only the first degree / 64 + 1 words are searched for a zero bit and the time is O(N + M).
+		*/
+		template<typename Graph>
+		static colors greedy(const Graph &G, const nodes &order){
+			NodeID N = G.number_of_nodes();
+			color null = -1;
+			colors result = colors(N, null);
+			std::vector<uint64_t> used = std::vector<uint64_t>();
+			
+			for(NodeID v: order){
+				NodeID degree = G.getNodeDegree(v);
+				if(used.size() < degree / 64 + 1){ used.resize(degree / 64 + 1, 0); }
+				for(NodeID u: G.neighbours(v)){
+					if(result[u] != null && result[u] <= degree){ used[result[u] / 64] |= uint64_t(1) << (result[u] % 64); }
+				}
+				
+				color c = 0;
+				for(size_t w = 0; ; ++w, c += 64){
+					if(~used[w]){
+						c += popcount::lowest(~used[w]);
+						break;
+					}
+				}
+				result[v] = c;
+				
+				std::fill(used.begin(), used.begin() + degree / 64 + 1, 0);
+			}
+			
+			return result;
+		}
+		
+		/*
+		Method: greedy
+		Return a coloring of the graph, which colors the nodes in the order of their IDs.
+		*/
+		template<typename Graph>
+		static colors greedy(const Graph &G){
+			nodes order = nodes(G.number_of_nodes());
+			for(NodeID v = 0; v < order.size(); ++v){ order[v] = v; }
+			return greedy(G, order);
+		}
+		
+		/*
+		Method: largest_first
+		Return the nodes in descending order of their degrees.
+		*/
+		template<typename Graph>
+		static nodes largest_first(const Graph &G){
+			return GraphReorder::degree_sorted(G);
+		}
+		
+		/*
+		Method: smallest_last
+		Return the reverse of the degeneracy order, so every node has at most degeneracy neighbours before it.
+		*/
+		template<typename Graph>
+		static nodes smallest_last(const Graph &G){
+			nodes core, order, position;
+			ColoringUpperBound::cores(G, core, order, position);
+			std::reverse(order.begin(), order.end());
+			return order;
+		}
+		
+		/*
+		Method: incidence_degree
+		Return the order, in which every next node has the most already ordered neighbours, starting from a node with the biggest degree.
+		The nodes are kept in buckets by the number of ordered neighbours. A node is pushed again, when the number grows,
+		and the outdated entries are skipped, so the time is O(N + M).
+		*/
+		template<typename Graph>
+		static nodes incidence_degree(const Graph &G){
+			NodeID N = G.number_of_nodes();
+			nodes result = nodes();
+			result.reserve(N);
+			nodes incidence = nodes(N, 0);
+			std::vector<bool> ordered = std::vector<bool>(N, false);
+			
+			// the last node of a bucket is taken first, so the nodes without ordered neighbours come by descending degree
+			std::vector<nodes> buckets = std::vector<nodes>(1);
+			buckets[0] = GraphReorder::degree_sorted(G);
+			std::reverse(buckets[0].begin(), buckets[0].end());
+			
+			NodeID top = 0;
+			while(result.size() < N){
+				if(buckets[top].empty()){
+					top--;
+					continue;
+				}
+				NodeID v = buckets[top].back();
+				buckets[top].pop_back();
+				if(ordered[v] || incidence[v] != top){ continue; }
+				
+				ordered[v] = true;
+				result.push_back(v);
+				for(NodeID u: G.neighbours(v)){
+					if(ordered[u]){ continue; }
+					if(++incidence[u] >= buckets.size()){ buckets.resize(incidence[u] + 1); }
+					buckets[incidence[u]].push_back(u);
+					top = std::max(top, incidence[u]);
+				}
+			}
+			
+			return result;
+		}
+		
+		/*
+		Method: jones_plassmann
+		Return a coloring of the graph, built on the worker threads with the algorithm of Jones and Plassmann.
+		Visit: <https://doi.org/10.1137/0914041>
+		
+		A node has priority over its neighbour, if it has a bigger degree, or the same degree and a bigger hash of its ID and SEED.
+		Every node waits for its neighbours with priority, the nodes, which wait for no uncolored neighbour, are colored in parallel in rounds.
+		They are never adjacent, so the result is the greedy coloring in priority order and does not depend on the number of threads.
+		*/
+		template<typename Graph>
+		static colors jones_plassmann(const Graph &G){
+			NodeID N = G.number_of_nodes();
+			color null = -1;
+			colors result = colors(N, null);
+			std::vector<uint64_t> hash = std::vector<uint64_t>(N);
+			std::vector<std::atomic<NodeID>> wait = std::vector<std::atomic<NodeID>>(N);
+			
+			auto before = [&](NodeID u, NodeID v){
+				NodeID du = G.getNodeDegree(u), dv = G.getNodeDegree(v);
+				if(du != dv){ return du > dv; }
+				if(hash[u] != hash[v]){ return hash[u] > hash[v]; }
+				return u > v;
+			};
+			
+			parallel::for_range(N, 4096, [&](size_t begin, size_t end){
+				for(NodeID v = begin; v < end; ++v){ hash[v] = mix(((uint64_t) SEED << 32) ^ v); }
+			});
+			
+			// the rounds are split in blocks, every block collects the nodes, which it releases, for the next round
+			unsigned threads = parallel::threads();
+			std::vector<nodes> ready = std::vector<nodes>(threads);
+			unsigned first = parallel::blocks_for(N, 4096);
+			parallel::for_each_block(first, [&](unsigned b){
+				for(NodeID v = (size_t) N * b / first, until = (size_t) N * (b + 1) / first; v < until; ++v){
+					NodeID count = 0;
+					for(NodeID u: G.neighbours(v)){
+						if(before(u, v)){ count++; }
+					}
+					wait[v].store(count, std::memory_order_relaxed);
+					if(count == 0){ ready[b].push_back(v); }
+				}
+			});
+			
+			nodes round = nodes();
+			std::vector<nodes> next = std::vector<nodes>(threads);
+			while(true){
+				round.clear();
+				for(nodes &r: ready){
+					round.insert(round.end(), r.begin(), r.end());
+					r.clear();
+				}
+				if(round.empty()){ break; }
+				
+				unsigned blocks = parallel::blocks_for(round.size(), 1024);
+				parallel::for_each_block(blocks, [&](unsigned b){
+					std::vector<uint64_t> used = std::vector<uint64_t>();
+					for(size_t i = round.size() * b / blocks, until = round.size() * (b + 1) / blocks; i < until; ++i){
+						NodeID v = round[i], degree = G.getNodeDegree(v);
+						if(used.size() < degree / 64 + 1){ used.resize(degree / 64 + 1, 0); }
+						// only the neighbours with priority are colored, none of them in this round
+						for(NodeID u: G.neighbours(v)){
+							if(result[u] != null && result[u] <= degree){ used[result[u] / 64] |= uint64_t(1) << (result[u] % 64); }
+						}
+						
+						color c = 0;
+						for(size_t w = 0; ; ++w, c += 64){
+							if(~used[w]){
+								c += popcount::lowest(~used[w]);
+								break;
+							}
+						}
+						result[v] = c;
+						std::fill(used.begin(), used.begin() + degree / 64 + 1, 0);
+						
+						for(NodeID u: G.neighbours(v)){
+							if(before(v, u) && wait[u].fetch_sub(1, std::memory_order_relaxed) == 1){ next[b].push_back(u); }
+						}
+					}
+				});
+				ready.swap(next);
+			}
+			
+			return result;
+		}
+		
+		/*
+		Method: dsatur
+		Return a coloring of the graph using the DSATUR strategy.
+		Visit: <https://doi.org/10.1145/359094.359101>
+		
+		The uncolored nodes are kept in buckets by saturation, the number of distinct colors among their neighbours.
+		Every bucket is a binary heap by the degree in the uncolored subgraph. A node is pushed again when its key changes,
+		the outdated entries are skipped when they reach the top, so the time is O((N + M) log N).
+		Every node has a bitset of the neighbour colors below its degree + 1, the smallest free color is always among them.
+		A neighbour color above the degree is checked against the adjacency of the node, which is short for such nodes.
+		*/
+		template<typename Graph>
+		static colors dsatur(const Graph &G){
+			NodeID N = G.number_of_nodes();
+			color null = -1;
+			colors result = colors(N, null);
+			if(N == 0){ return result; }
+			
+			// the bitset of v starts at the word first[v] and covers the colors 0 .. degree of v
+			nodes degree = nodes(N), saturation = nodes(N, 0);
+			std::vector<size_t> first = std::vector<size_t>(N + 1, 0);
+			NodeID D = 0;
+			for(NodeID v = 0; v < N; ++v){
+				degree[v] = G.getNodeDegree(v);
+				first[v + 1] = first[v] + degree[v] / 64 + 1;
+				D = std::max(D, degree[v]);
+			}
+			std::vector<uint64_t> used = std::vector<uint64_t>(first[N], 0);
+			
+			// the heap entries are (uncolored degree, node), ties go to the higher node ID
+			std::vector<upairs> buckets = std::vector<upairs>(D + 1);
+			for(NodeID v = 0; v < N; ++v){ buckets[0].push_back(std::make_pair(degree[v], v)); }
+			std::make_heap(buckets[0].begin(), buckets[0].end());
+			
+			NodeID top = 0;
+			for(NodeID i = 0; i < N; ++i){
+				NodeID v;
+				while(true){
+					upairs &heap = buckets[top];
+					if(heap.empty()){
+						top--;
+						continue;
+					}
+					upair entry = heap.front();
+					std::pop_heap(heap.begin(), heap.end());
+					heap.pop_back();
+					v = entry.second;
+					if(result[v] == null && saturation[v] == top && degree[v] == entry.first){ break; }
+				}
+				
+				color c = 0;
+				const uint64_t* bits = &used[first[v]];
+				for(size_t w = 0; ; ++w, c += 64){
+					if(~bits[w]){
+						c += popcount::lowest(~bits[w]);
+						break;
+					}
+				}
+				result[v] = c;
+				
+				for(NodeID u: G.neighbours(v)){
+					if(result[u] != null){ continue; }
+					degree[u]--;
+					
+					bool fresh;
+					if((NodeID) c <= G.getNodeDegree(u)){
+						uint64_t mask = uint64_t(1) << (c % 64);
+						fresh = !(used[first[u] + c / 64] & mask);
+						used[first[u] + c / 64] |= mask;
+					} else {
+						fresh = true;
+						for(NodeID w: G.neighbours(u)){
+							if(w != v && result[w] == c){ fresh = false; break; }
+						}
+					}
+					
+					if(fresh){
+						saturation[u]++;
+						top = std::max(top, saturation[u]);
+					}
+					upairs &heap = buckets[saturation[u]];
+					heap.push_back(std::make_pair(degree[u], u));
+					std::push_heap(heap.begin(), heap.end());
+				}
+			}
+			
+			return result;
+		}
+		
+		template<typename Graph>
+		colors build(const Graph &G){
+			switch(BUILD_STRATEGY){
+				case BuildStrategy::RandomStart:
+					return random(G, bound.calculate(G), engine);
+				case BuildStrategy::Greedy:
+					return greedy(G);
+				case BuildStrategy::LargestFirst:
+					return greedy(G, largest_first(G));
+				case BuildStrategy::SmallestLast:
+					return greedy(G, smallest_last(G));
+				case BuildStrategy::IncidenceDegree:
+					return greedy(G, incidence_degree(G));
+				case BuildStrategy::JonesPlassmann:
+					return jones_plassmann(G);
+				case BuildStrategy::Bipartite:
+					return bipartite(G);
+				case BuildStrategy::Dsatur:
+					return dsatur(G);
+				default:
+					std::cout << "Not supported build method" << std::endl;
+					exit(1);
+			}
+		}
+	};
+	
+	/*
+	Class: GuidedLocalSearch
+	Implementation of the Guided Local Search Algorithm
+	
+	Visit: <http://www.cleveralgorithms.com/nature-inspired/stochastic/guided_local_search.html>
+	
+	Improvements that are added:
+    
+	- Dynamic optimization of the restricted one exchange neighbourhood
+    - Aspiration movements
+	- Optional external reset of the weights
+	- Execution timeout
+	
+	T is the integer type of the scores and the weights, delta or wide_delta.
+	*/
+	template<typename T = delta>
+	class GuidedLocalSearch {
+	private:
+		typedef BasicNodeColorScore<T> NodeColorScore;
+		typedef BasicDeltaScore<T> DeltaScore;
+		typedef BasicMove<T> Move;
+		typedef std::vector<Move> Moves;
+		
+		/*
+		 Field: N
+		 Number of nodes
+		 */
+		NodeID N;
 		/*
 		 Field: M
 		 Number of edges
 		 */
-		uint M;
+		EdgeID M;
 		/*
 		 Field: K
 		 Number of colors
 		 */
 		uint K;
+		/*
+		 Field: degree
+		 Maximal degree of a node
+		 */
+		EdgeID degree;
 		/*
 		 Field: solution
 		 The best found so far solution in the current epoche
@@ -1124,62 +2563,239 @@ namespace gls {
 		 List of all available one-exchange moves for the current improvement.
 		 */
 		Moves neighbors;
+		/*
+		 Field: improvement
+		 The coloring, which the search changes in the current epoche
+		 */
+		colors improvement;
 		/*
 		 Field: solution_score
 		 The score of the best found so far solution in the current epoche
 		 */
 		Score solution_score;
 		/*
-		 Field: conflicts
-		 Array with the conflicts with size K * N
+		 Field: scores
+		 The conflicts and guidance of every node with every color. The row of a node has stride entries and starts at a cache line,
+		 so a move touches one or two cache lines of every neighbour instead of two or four in separate arrays.
 		 */
-		delta* conflicts;
+		NodeColorScore* scores;
 		/*
-		 Field: guidance
-		 Array with the guidance with size K * N
+		 Field: capacity
+		 Number of allocated entries in scores. It only grows, so a smaller graph or fewer colors reuse the rows.
 		 */
-		delta* guidance;
+		moveid capacity;
+		/*
+		 Field: stride
+		 Number of entries in a row of scores, K rounded up to whole cache lines
+		 */
+		moveid stride;
 		/*
 		 Field: weights
-		 Array with the current weights of the edges
+		 Array with the current weights of the directed edges, both halves of an edge are raised together and keep the same weight
+		 */
+		std::vector<T> weights;
+		/*
+		 Field: load
+		 Sum of the weights of the edges of every node. It bounds every guidance of the node, see <weight_cap>.
+		 */
+		std::vector<T> load;
+		/*
+		 Field: totals
+		 The totals of the moves of the last evaluated row, see <evaluate>
+		 */
+		std::vector<int32_t> totals;
+		/*
+		 Field: ties
+		 Bitset of the colors with the smallest total in the last evaluated row
+		 */
+		std::vector<uint64_t> ties;
+		/*
+		 Field: candidates
+		 The moves of the restricted neighbourhood in the current iteration
+		 */
+		Moves candidates;
+		/*
+		 Field: aspirations
+		 The aspiration moves in the current iteration
+		 */
+		Moves aspirations;
+		/*
+		 Field: updates
+		 The moves, whose scores are changed by the current move or weights update
+		 */
+		Moves updates;
+		/*
+		 Field: penalized
+		 The same colored halves of the edges with maximal utility in a weights update, as the pair of their nodes and the index of the half
+		 */
+		std::vector<std::pair<upair, EdgeID>> penalized;
+		/*
+		 Field: refresh
+		 The nodes of the penalized edges
 		 */
-		delta* weights;
+		nodes refresh;
+		/*
+		 Field: pending
+		 Number of the penalized halves of every node in a weights update, zero between the updates
+		 */
+		nodes pending;
+		/*
+		 Field: classes
+		 Bitsets of the color classes, used with the bitset adjacencies of a dense graph
+		 */
+		std::vector<uint64_t> classes;
+		/*
+		 Field: conflicting
+		 The nodes with conflicts in the current coloring, so the searches without queues scan only them
+		 */
+		NodeSet conflicting;
+		/*
+		 Field: random
+		 Engine of the choice between the best moves, every solver has its own
+		 */
+		std::mt19937 random;
 		/*
 		 Field: Q
 		 Priority queue of all movements
 		 ORDER BY total ASC    
 		*/
-		MovesQueue<Move, MoveTotalCompare> Q;
+		MovesQueue<Move, BasicMoveTotalCompare<T>> Q;
 		/*
 		 Field: A
 		 Priority queue of all movements
 		 ORDER BY conflicts ASC    
 		*/
-		MovesQueue<Move, MoveConflictsCompare> A;
+		MovesQueue<Move, BasicMoveConflictsCompare<T>> A;
+		/*
+		Method: row
+		Returns the scores of node v.
+		*/
+		inline NodeColorScore* row(NodeID v) const {
+			return scores + stride * v;
+		}
+		/*
+		Method: evaluate
+		Computes the totals of the moves of node v from color from to all K colors in one pass over its row with the widest SIMD kernel of the processor.
+		Returns the smallest total of a move to another color and marks the colors with it in ties.
+		*/
+		inline int32_t evaluate(NodeID v, color from){
+			static_assert(sizeof(NodeColorScore) == 2 * sizeof(T), "the kernels read a row as pairs of T");
+			return score_kernels::evaluate(&row(v)->conflicts, from, K, LAMBDA, totals.data(), ties.data());
+		}
+		/*
+		Method: evaluated
+		Returns the score of the move of a node with the row r from color from to color c, after the row was evaluated.
+		*/
+		inline DeltaScore evaluated(const NodeColorScore* r, color c, color from) const {
+			DeltaScore result;
+			result.conflicts = r[c].conflicts - r[from].conflicts;
+			result.guidance = r[c].guidance - r[from].guidance;
+			assert(totals[c] >= std::numeric_limits<T>::min() && totals[c] <= std::numeric_limits<T>::max());
+			result.total = (T) totals[c];
+			return result;
+		}
+		/*
+		Method: use_colors
+		Sets the number of colors of the next epoch and the stride of the score rows.
+		*/
+		void use_colors(uint k){
+			K = k;
+			stride = (moveid) (K + scores_per_line<T>() - 1) / scores_per_line<T>() * scores_per_line<T>();
+		}
+		/*
+		Method: weight_cap
+		Returns the bound of the weight sums in load, under which 10 * conflicts + LAMBDA * guidance of every move fits in T.
+		*/
+		T weight_cap() const {
+			int64_t space = (int64_t) std::numeric_limits<T>::max() - 10 * (int64_t) degree;
+			return (T) std::max<int64_t>(space / std::max<int64_t>(LAMBDA, 1), 0);
+		}
+		/*
+		Method: build_structs
+		Builds the conflicts and guideance structures according to a given coloring of a graph G.
+		Additionally, if the CLEAR_WEIGHTS flags is up, the weights are cleaned.
+		Uf priority queues are used, then they are also build here.
+		*/
+		template<typename Graph>
+		void build_structs(const Graph &G, const colors &coloring){
+			for(NodeID v = 0; v < N; ++v) {
+				NodeColorScore* r = row(v);
+				for(uint i = 0; i < K; ++i){
+					r[i].conflicts = 0;
+					r[i].guidance  = 0;
+				}
+				if(RESET_WEIGHTS){ load[v] = 0; }
+				EdgeID e = G.get_first_edge(v);
+				for(NodeID u: G.neighbours(v)){
+					r[coloring[u]].conflicts++;
+					if(RESET_WEIGHTS){
+						weights[e] = 0;
+					} else {
+						r[coloring[u]].guidance += weights[e];
+					}
+					e++;
+				}
+			}
+		}
 		/*
 		Method: build_structs
-		Builds the conflicts and guideance structures according to a given coloring of a graph G.
-		Additionally, if the CLEAR_WEIGHTS flags is up, the weights are cleaned.
-		Uf priority queues are used, then they are also build here.
+		Builds the structures for a dense graph. The conflicts of node v with color c are the popcount of the adjacency row of v and the class of c.
 		*/
-		void build_structs(const graph_access &G, const colors &coloring){
-			uint ID;
+		void build_structs(const dense_graph &G, const colors &coloring){
+			G.node_sets(coloring, K, classes);
+			size_t W = G.words();
 			for(NodeID v = 0; v < N; ++v) {
+				NodeColorScore* r = row(v);
 				for(uint i = 0; i < K; ++i){
-					ID = K*v + i;
-					conflicts[ID] = 0;
-					guidance[ID]  = 0;
-				}
-				EdgeID until = G.get_first_invalid_edge(v);
-				for(EdgeID e = G.get_first_edge(v); e < until; ++e){
-					NodeID u = G.getEdgeTarget(e);
-					ID = K*v + coloring[u];
-					conflicts[ID]++;
-					if(RESET_WEIGHTS){
-						weights[e] = 0;
-					} else {
-						guidance[ID] += weights[e];
+					r[i].conflicts = G.count_neighbours(v, &classes[i * W]);
+					r[i].guidance  = 0;
+				}
+				if(RESET_WEIGHTS){
+					load[v] = 0;
+					for(EdgeID e = G.get_first_edge(v); e < G.get_first_invalid_edge(v); ++e){ weights[e] = 0; }
+				} else {
+					EdgeID e = G.get_first_edge(v);
+					for(NodeID u: G.neighbours(v)){
+						r[coloring[u]].guidance += weights[e++];
+					}
+				}
+			}
+		}
+		/*
+		Method: same_colored
+		Calls f(v, u, e) for every edge e from v to u, which connects two nodes with the same color. Both halves of an edge are visited.
+		*/
+		template<typename Graph, typename F>
+		void same_colored(const Graph &G, const colors &coloring, F f){
+			for(NodeID v = 0; v < N; ++v) {
+				EdgeID e = G.get_first_edge(v);
+				for(NodeID u: G.neighbours(v)){
+					if(coloring[v] == coloring[u]){ f(v, u, e); }
+					e++;
+				}
+			}
+		}
+		/*
+		Method: same_colored
+		Finds the same colored edges of a dense graph from the AND of the adjacency rows with the color classes.
+		The edge ID is the first edge of v plus the rank of the target in its row.
+		*/
+		template<typename F>
+		void same_colored(const dense_graph &G, const colors &coloring, F f){
+			G.node_sets(coloring, K, classes);
+			size_t W = G.words();
+			for(NodeID v = 0; v < N; ++v) {
+				const uint64_t* row = G.row(v);
+				const uint64_t* cls = &classes[coloring[v] * W];
+				EdgeID e = G.get_first_edge(v);
+				for(size_t w = 0; w < W; ++w){
+					uint64_t same = row[w] & cls[w];
+					while(same){
+						uint64_t below = (same & (0 - same)) - 1;
+						f(v, (NodeID) (w * 64 + popcount::lowest(same)), e + popcount::word(row[w] & below));
+						same &= same - 1;
 					}
+					e += popcount::word(row[w]);
 				}
 			}
 		}
@@ -1188,103 +2804,166 @@ namespace gls {
 		Calculates the utilites of the edges and then increment the value of the weights with 1 for edges having maximal utility.
 		Returns the number of edges, which have changed weights.
 		Addituionally it updates the score to the new guidance.
+		An edge is raised only if both of its nodes can take all of their penalized halves under <weight_cap>, so the scores can not overflow T
+		and both halves of an edge keep the same weight. If the cap blocks an edge, the weights are rescaled first, see <rescale_weights>.
+		The updated moves are written to updates.
 		*/
-		Moves update_weights(const graph_access &G, const colors &coloring, Score &score){
-			std::vector<std::pair<NodeID, EdgeID>> E;// = std::vector<std::pair<NodeID, EdgeID>>();
-			std::set<NodeID> refresh = std::set<NodeID>();
+		template<typename Graph>
+		void update_weights(const Graph &G, const colors &coloring, Score &score, Moves &updates){
+			penalized.clear();
+			refresh.clear();
 			
 			float max = 0, utility = 0;
-			for(NodeID v = 0; v < N; ++v) {
-				EdgeID until = G.get_first_invalid_edge(v);
-				for(EdgeID e = G.get_first_edge(v); e < until; ++e){
-					NodeID u = G.getEdgeTarget(e);
-					if(coloring[v] != coloring[u]){ continue; }
-					
-					utility = 1.0 / float(1 + weights[e]);
-					if(utility > max){
-						max = utility;
-						E = std::vector<std::pair<NodeID, EdgeID>>();
-						refresh = std::set<NodeID>();
-					}
-					
-					if(utility == max){
-						std::pair<NodeID, EdgeID> update = std::make_pair(v, e);
-						E.push_back(update);
-						refresh.insert(v);
-					}
+			same_colored(G, coloring, [&](NodeID v, NodeID u, EdgeID e){
+				utility = 1.0 / float(1 + weights[e]);
+				if(utility > max){
+					max = utility;
+					penalized.clear();
+					refresh.clear();
+				}
+				
+				if(utility == max){
+					penalized.push_back(std::make_pair(std::make_pair(v, u), e));
+					refresh.push_back(v);
+				}
+			});
+			// the moves of the nodes are updated in ascending order and only once
+			std::sort(refresh.begin(), refresh.end());
+			refresh.erase(std::unique(refresh.begin(), refresh.end()), refresh.end());
+			
+			T cap = weight_cap();
+			for(std::pair<upair, EdgeID> edge: penalized){ pending[edge.first.first]++; }
+			auto blocked = [&](const std::pair<upair, EdgeID> &edge){
+				NodeID v = edge.first.first, u = edge.first.second;
+				return load[v] + pending[v] > cap || load[u] + pending[u] > cap;
+			};
+			// halving helps only if a blocked edge has a weighted node
+			for(std::pair<upair, EdgeID> edge: penalized){
+				if(blocked(edge) && (load[edge.first.first] > 0 || load[edge.first.second] > 0)){
+					rescale_weights(G, coloring, score, cap);
+					break;
 				}
 			}
+			// the edges are dropped before any weight is raised, so both halves of an edge are dropped together
+			penalized.erase(std::remove_if(penalized.begin(), penalized.end(), blocked), penalized.end());
+			for(NodeID v: refresh){ pending[v] = 0; }
 			
-			score = Score::build(score.conflicts, score.guidance + E.size() / 2);
-			for(std::pair<NodeID, EdgeID> edge: E){
-				guidance[K*edge.first + coloring[edge.first]]++;
+			for(std::pair<upair, EdgeID> edge: penalized){
+				NodeID v = edge.first.first;
+				row(v)[coloring[v]].guidance++;
 				weights[edge.second]++;
+				load[v]++;
 			}
+			score = Score::build(score.conflicts, score.guidance + penalized.size() / 2);
 			
-			uint src;
 			Move mv;
-			Moves updates = Moves();
+			updates.clear();
 			for(NodeID v: refresh){
+				const NodeColorScore* r = row(v);
+				evaluate(v, coloring[v]);
 				for(color c = 0; c < K; c++){						
-					src = K * v + coloring[v];
 					mv = Move(v, c, K);
-					mv.score = DeltaScore::build(conflicts[mv.ID] - conflicts[src], guidance[mv.ID] - guidance[src]);
+					mv.score = evaluated(r, c, coloring[v]);
 					updates.push_back(mv);
 				}
 			}
+		}
+		/*
+		Method: rescale_weights
+		Halves all weights until every load is at most the half of cap, so the next updates are not blocked by <weight_cap>.
+		The guidance, the loads, the score and all moves are built again from the weights. The rescale is counted in the report.
+		*/
+		template<typename Graph>
+		void rescale_weights(const Graph &G, const colors &coloring, Score &score, T cap){
+			T highest = 0;
+			do {
+				for(T &w: weights){ w /= 2; }
+				highest = 0;
+				for(NodeID v = 0; v < N; ++v){
+					NodeColorScore* r = row(v);
+					for(uint i = 0; i < K; ++i){ r[i].guidance = 0; }
+					load[v] = 0;
+					EdgeID e = G.get_first_edge(v);
+					for(NodeID u: G.neighbours(v)){
+						T w = weights[e++];
+						r[coloring[u]].guidance += w;
+						load[v] += w;
+					}
+					highest = std::max(highest, load[v]);
+				}
+			} while(highest > cap / 2);
 			
-			return updates;
+			score = build_score(coloring);
+			load_neighbors(coloring);
+			report.rescale();
 		}
 		/*
 		Method: build_score
 		Builds the score of a given colorring.
 		*/
 		Score build_score(const colors &coloring){
-			uint c = 0, g = 0;
+			scoresum c = 0, g = 0;
 			for(NodeID v = 0; v < N; v++){
-				c += conflicts[K*v + coloring[v]];
-				g += guidance[K*v + coloring[v]];
+				c += row(v)[coloring[v]].conflicts;
+				g += row(v)[coloring[v]].guidance;
 			}
 			return Score::build(c / 2, g / 2);
 		}
 		/*
 		Method: make_move
 		Applies the next move to a given colring of the graph G with known score.
-		Additionally, it applies the move to the conflicts and guidance structures.
-		Returns a list with updated moves by applying the move.
+		Additionally, it applies the move to the conflicts and guidance structures and to the set of conflicting nodes.
+		The moves, which are updated by applying the move, are written to updates.
 		*/
-		Moves make_move(const graph_access &G, colors &coloring, Score &score, Move next){
-			Moves updates = Moves();
+		template<typename Graph>
+		void make_move(const Graph &G, colors &coloring, Score &score, Move next, Moves &updates){
+			updates.clear();
 			Move mv;
 			
-			uint src, dest;
-			EdgeID until = G.get_first_invalid_edge(next.node);
-			for(EdgeID e = G.get_first_edge(next.node); e < until; e++){
-				NodeID u = G.getEdgeTarget(e);
-				src = K*u + coloring[next.node], dest = K*u + next.to; 
-				
-				conflicts[src]--;
-				guidance[src] -= weights[e];
-				
-				conflicts[dest]++;
-				guidance[dest] += weights[e];
+			// the row of a neighbour is prefetched one step before it is updated
+			const color from = coloring[next.node];
+			EdgeID e = G.get_first_edge(next.node);
+			NodeColorScore* previous = NULL;
+			T weight = 0;
+			for(NodeID u: G.neighbours(next.node)){
+				NodeColorScore* r = row(u);
+				prefetch(r + from);
+				prefetch(r + next.to);
+				if(previous != NULL){
+					previous[from].conflicts--;
+					previous[from].guidance -= weight;
+					previous[next.to].conflicts++;
+					previous[next.to].guidance += weight;
+				}
+				previous = r;
+				weight = weights[e++];
+			}
+			if(previous != NULL){
+				previous[from].conflicts--;
+				previous[from].guidance -= weight;
+				previous[next.to].conflicts++;
+				previous[next.to].guidance += weight;
 			}
 			
-			for(EdgeID e = G.get_first_edge(next.node); e < until; e++){
-				NodeID u = G.getEdgeTarget(e);
+			for(NodeID u: G.neighbours(next.node)){
+				const NodeColorScore* r = row(u);
+				conflicting.set(u, r[coloring[u]].conflicts > 0);
+				evaluate(u, coloring[u]);
 				for(uint c = 0; c < K; c++){
 					mv = Move(u, c, K);
-					src = K * u + coloring[u];
-					mv.score = DeltaScore::build(conflicts[mv.ID] - conflicts[src], guidance[mv.ID] - guidance[src]);
+					mv.score = evaluated(r, c, coloring[u]);
 					updates.push_back(mv);
 				}
 			}
 			
+			const NodeColorScore* r = row(next.node);
+			conflicting.set(next.node, r[next.to].conflicts > 0);
+			evaluate(next.node, next.to);
 			for(uint c = 0; c < K; c++){
 				mv = Move(next.node, c, K);
-				mv.score = DeltaScore::build(conflicts[mv.ID] - conflicts[next.ID], guidance[mv.ID] - guidance[next.ID]);
+				mv.score = evaluated(r, c, next.to);
 				if(FAST_SEARCH && mv.ID == next.ID){
-					mv.score.total = std::numeric_limits<delta>::max();
+					mv.score.total = std::numeric_limits<T>::max();
 				}
 				updates.push_back(mv);
 			}
@@ -1293,16 +2972,14 @@ namespace gls {
 			score.guidance  += next.score.guidance;
 			score.total 	+= next.score.total;
 			coloring[next.node] = next.to;
-			
-			return updates;
 		}
 		/*
 		Method: update_neighbors
 		Update the neighbors according to a given list with updates moves.
 		Record the changes in the priority among the queues.
 		*/
-		void update_neighbors(Moves &updates){
-			for(Move mv: updates){
+		void update_neighbors(const Moves &updates){
+			for(const Move &mv: updates){
 				if(neighbors[mv.ID].score.conflicts == mv.score.conflicts &&
 					neighbors[mv.ID].score.guidance == mv.score.guidance){
 					continue;
@@ -1318,31 +2995,28 @@ namespace gls {
 		}
 		/*
 		Method: build_neighbors
-		Biuld all available moves in the one-exchange neighborhood.
+		Biuld all available moves in the one-exchange neighborhood into moves.
 		*/
-		Moves build_neighbors(const colors &coloring){
-			Moves moves = Moves();
-			moves.reserve(K * N);
+		void build_neighbors(const colors &coloring, Moves &moves){
+			moves.clear();
+			moves.reserve((moveid) K * N);
 			for(NodeID v = 0; v < N; v++){
-				const uint sourceID = K*v + coloring[v];
+				const NodeColorScore* r = row(v);
+				// the move to the own color gets the total 0
+				evaluate(v, coloring[v]);
 				for(uint c = 0; c < K; c++){
 					Move mv = Move(v, c, K);
-					if (coloring[v] == c){
-						mv.score = DeltaScore::build(0, 0);
-					} else {
-						mv.score = DeltaScore::build(conflicts[mv.ID] - conflicts[sourceID], guidance[mv.ID] - guidance[sourceID]);
-					}
+					mv.score = evaluated(r, c, coloring[v]);
 					moves.push_back(mv);
 				}
 			}
-			return moves;
 		}
 		/*
 		Method: load_neighbors
 		Builds all neighbors and loads them in the priority queues.
 		*/
 		void load_neighbors(const colors &coloring){
-			neighbors = build_neighbors(solution);
+			build_neighbors(coloring, neighbors);
 			if(MOVE_QUEUE){
 				Q.build(neighbors);
 				if(ASPIRATION){ A.build(neighbors); }
@@ -1361,126 +3035,178 @@ namespace gls {
 		/*
 		 Method: restrict_neighbours
 		 Restrict a moves list to the restricted one-exchange neighbourhood of a given coloring with estimated score.
+		 The restricted moves are written to moves.
 		*/
-		Moves restrict_neighbours(const Moves &neighbors, const colors &coloring, Score score){
-			Moves moves = Moves();
+		void restrict_neighbours(const Moves &neighbors, const colors &coloring, Score score, Moves &moves){
+			moves.clear();
+			auto is_conflicting = [&](NodeID v){ return conflicting.contains(v); };
 			
 			if(MOVE_QUEUE){
 				if(ASPIRATION){
-					Moves aspirations = A.head(coloring, conflicts, K);
+					A.head(coloring, is_conflicting, aspirations);
 					if(aspirations.size() > 0){
 						Move asp = aspirations.front();
 						if(is_aspiration(asp, score)){
 							moves.push_back(asp);
-							return moves;
+							return;
 						}
 					}
 				}
-				moves = Q.head(coloring, conflicts, K);
+				Q.head(coloring, is_conflicting, moves);
 			} else {
-				MoveTotalCompare tCmp = MoveTotalCompare(); 
-				MoveConflictsCompare cCmp = MoveConflictsCompare(); 
+				BasicMoveTotalCompare<T> tCmp = BasicMoveTotalCompare<T>(); 
+				BasicMoveConflictsCompare<T> cCmp = BasicMoveConflictsCompare<T>(); 
 				
 				DeltaScore best = neighbors[coloring[0]].score;
 				DeltaScore asp = neighbors[coloring[0]].score;
 				
-				Moves aspirations = Moves();
+				aspirations.clear();
 				
-				for(Move mv: neighbors){
-					const uint sourceID = K*mv.node + coloring[mv.node];
-					if(conflicts[sourceID] == 0){ continue; }
-					if(coloring[mv.node] == mv.to){ continue; }
-					if(tCmp.weak(mv.score, best)){
-						best = mv.score;
-						moves = Moves();
-					}
-					if(tCmp(mv.score, best)){
-						moves.push_back(mv);
-					}
-					
-					if(ASPIRATION){					
-						if(cCmp.weak(mv.score, asp)){
-							asp = mv.score;
-							aspirations = Moves();
+				// only the moves of the conflicting nodes are scanned, O(|conflicting| * K) instead of O(N * K)
+				for(NodeID v: conflicting){
+					for(const Move *mv = &neighbors[(moveid) K * v], *end = mv + K; mv < end; mv++){
+						if(coloring[v] == mv->to){ continue; }
+						if(tCmp.weak(mv->score, best)){
+							best = mv->score;
+							moves.clear();
+						}
+						if(tCmp(mv->score, best)){
+							moves.push_back(*mv);
 						}
 						
-						if(cCmp(mv.score, asp) && is_aspiration(mv, score)){
-							moves.push_back(mv);
+						if(ASPIRATION){					
+							if(cCmp.weak(mv->score, asp)){
+								asp = mv->score;
+								aspirations.clear();
+							}
+							
+							if(cCmp(mv->score, asp) && is_aspiration(*mv, score)){
+								moves.push_back(*mv);
+							}
 						}
 					}
 				}				
 				if(ASPIRATION && aspirations.size() > 0){
-					return aspirations;
+					moves.assign(aspirations.begin(), aspirations.end());
 				}
 			}
-			
-			return moves;
 		}
 		/*
 		 Method: best_neighbours
-		 Full scan search of the restricted one-exchange neighbourhood of a given coloring
+		 Full scan search of the restricted one-exchange neighbourhood of a given coloring, the best moves are written to moves.
+		 Only the rows of the conflicting nodes are evaluated.
 		*/
-		Moves best_neighbours(const colors coloring){ 
-			Move best = Move();
-			Moves moves;
-			for(NodeID v = 0; v < N; v++){
-				const uint sourceID = K*v + coloring[v];
-				if(conflicts[sourceID] == 0){ continue; }
-				for(uint c = 0; c < K; c++){
-					if(coloring[v] == c){ continue; }
-					Move mv = Move(v, c, K);
-					mv.score = DeltaScore::build(conflicts[mv.ID] - conflicts[sourceID], guidance[mv.ID] - guidance[sourceID]);
-					if(mv.score.total < best.score.total){
-						best = mv;
-						moves = Moves();
-					}
-					if(mv.score.total == best.score.total){
+		void best_neighbours(const colors &coloring, Moves &moves){ 
+			int32_t best = 0;
+			moves.clear();
+			for(NodeID v: conflicting){
+				const NodeColorScore* r = row(v);
+				int32_t minimum = evaluate(v, coloring[v]);
+				if(minimum > best){ continue; }
+				if(minimum < best){
+					best = minimum;
+					moves.clear();
+				}
+				for(size_t w = 0; w < (K + 63) / 64; w++){
+					for(uint64_t bits = ties[w]; bits; bits &= bits - 1){
+						color c = w * 64 + popcount::lowest(bits);
+						Move mv = Move(v, c, K);
+						mv.score = evaluated(r, c, coloring[v]);
 						moves.push_back(mv);
 					}
 				}
 			}
-			return moves;
 		}
 		
 		public:
 		
 		SolveReport report;
 		
+		GuidedLocalSearch() : scores(NULL), capacity(0), random(SEED) {}
+		
+		GuidedLocalSearch(const GuidedLocalSearch&) = delete;
+		GuidedLocalSearch& operator=(const GuidedLocalSearch&) = delete;
+		
 		/*
 		 Method: ~GuidedLocalSearch
 		 Destructs a solver, by freeing the memory for the internal arrays.
 		*/
 		~GuidedLocalSearch(){
-			delete [] conflicts;
-			delete [] guidance;
-			delete [] weights;
+			::operator delete[](scores, std::align_val_t(64));
+		}
+		
+		/*
+		 Method: seed
+		 Restarts the engine of the search from the seed sequence.
+		*/
+		void seed(std::seed_seq &sequence){
+			random.seed(sequence);
+		}
+		
+		/*
+		 Method: prepare
+		 Allocates the structures for the graph G and at most k colors and starts the report of the solution.
+		*/
+		template<typename Graph>
+		void prepare(const Graph &G, const colors &coloring, const uint &k){
+			allocate(G, k);
+			report.prepare(K);
 		}
 		
-		void prepare(const graph_access &G, const colors &coloring, const uint &k){
+		/*
+		 Method: allocate
+		 Allocates the structures for the graph G and at most k colors. The memory of a previous graph is reused, if it is big enough,
+		 so the solver does not allocate again in the epoches and in repeated runs on graphs of the same size.
+		*/
+		template<typename Graph>
+		void allocate(const Graph &G, const uint &k){
 			N = G.number_of_nodes();
 			M = G.number_of_edges();
-			K = k;
-			
-			conflicts = new delta[K * N];
-			guidance = new delta[K * N];
-			weights = new delta[M];
-			for(EdgeID e = 0;e<M;e++){weights[e]=0;}
+			use_colors(k);
+			degree = 0;
+			for(NodeID v = 0; v < N; v++){ degree = std::max<EdgeID>(degree, G.getNodeDegree(v)); }
+			
+			// the rows start at cache lines, the stride for fewer colors in later epoches is not bigger
+			if(stride * N > capacity){
+				::operator delete[](scores, std::align_val_t(64));
+				capacity = stride * N;
+				scores = static_cast<NodeColorScore*>(::operator new[](sizeof(NodeColorScore) * capacity, std::align_val_t(64)));
+			}
+			
+			weights.assign(M, 0);
+			load.assign(N, 0);
+			pending.assign(N, 0);
+			totals.assign(k, 0);
+			ties.assign((k + 63) / 64, 0);
+			conflicting.prepare(N);
+			
+			// a move updates the moves of the node and its neighbours, a weights update the moves of up to every node
+			updates.reserve((moveid) std::max<EdgeID>(degree + 1, N) * k);
+			// the heads of the queues have at most HEAD_CAPACITY + 1 moves, the scan without them keeps a move as a tie and once more as an aspiration
+			candidates.reserve(MOVE_QUEUE ? HEAD_CAPACITY + 1 : (moveid) (ASPIRATION ? 2 : 1) * N * k);
+			aspirations.reserve(HEAD_CAPACITY + 1);
+			// a weights update penalizes at most every half of an edge
+			penalized.reserve(M);
+			refresh.reserve(M);
 			
 			if(MOVE_QUEUE){
-				Q.prepare(N * K);
-				if(ASPIRATION){ A.prepare(N * K); }
+				Q.prepare((moveid) N * K);
+				if(ASPIRATION){ A.prepare((moveid) N * K); }
 			}
-			
-			report.prepare(K);
 		}
 		
 		/*
 		 Method: solve
 		 Applies the GLS strategy to solve the k-coloring problem for an initial coloring of a graph G. 
 		*/
-		colors solve(const graph_access &G, const colors &coloring, const uint k){
-			K = k;
+		template<typename Graph>
+		colors solve(const Graph &G, const colors &coloring, const uint k){
+			use_colors(k);
 			build_structs(G, coloring);
+			conflicting.clear();
+			for(NodeID v = 0; v < N; v++){
+				if(row(v)[coloring[v]].conflicts > 0){ conflicting.insert(v); }
+			}
 			solution = coloring;
 			solution_score = build_score(solution);
 			if(solution_score.conflicts == 0){
@@ -1492,7 +3218,7 @@ namespace gls {
 			
 			load_neighbors(solution);
 			
-			colors improvement = solution;
+			improvement = solution;
 			Score score = solution_score;
 			SolveResolution resolution = SolveResolution::NotFound;
 			
@@ -1505,15 +3231,16 @@ namespace gls {
 					break;
 				}
 				
-				Moves moves = restrict_neighbours(neighbors, improvement, score);
+				// the moves of an iteration are kept in the scratch vectors of the solver, so the loop does not allocate
+				restrict_neighbours(neighbors, improvement, score, candidates);
 				
-				if(moves.size() == 0){
+				if(candidates.size() == 0){
 					resolution = report.minimum();
 				} else {
-					Move next = moves[rand() % moves.size()];
+					Move next = candidates[random() % candidates.size()];
 					resolution = report.check_move(next);
 					
-					Moves updates = make_move(G, improvement, score, next);
+					make_move(G, improvement, score, next, updates);
 					update_neighbors(updates);
 					
 					report.report_move(next, score);
@@ -1527,7 +3254,7 @@ namespace gls {
 				
 				if(resolution == SolveResolution::NoImprove || resolution == SolveResolution::LocalMin){
 					report.weight_update();
-					Moves updates = update_weights(G, improvement, score);
+					update_weights(G, improvement, score, updates);
 					update_neighbors(updates);
 					resolution = SolveResolution::NotFound;
 				}
@@ -1544,6 +3271,135 @@ namespace gls {
 		}
 	};
 	
+	/*
+	 Class: CorePeeling
+	 Reduces the k-coloring problem to the k-core of the graph.
+	 
+	 A node with less than k neighbours can always be colored after them. The nodes are peeled in degeneracy order,
+	 the search runs only on the nodes with core number at least k and the peeled nodes are colored greedily in reverse order.
+	 */
+	class CorePeeling{
+	private:
+		/*
+		 Field: core
+		 The core number of every node
+		 */
+		nodes core;
+		/*
+		 Field: order
+		 The nodes in degeneracy order, the core numbers along it do not decrease
+		 */
+		nodes order;
+		/*
+		 Field: position
+		 The position of every node in order
+		 */
+		nodes position;
+		/*
+		 Field: H
+		 The core, on which the solver was allocated last
+		 */
+		graph_access H;
+		/*
+		 Field: prepared
+		 The number of nodes of the graph, on which the solver was allocated last
+		 */
+		NodeID prepared;
+		
+		/*
+		 Method: induced
+		 Builds H from the last size nodes in order, node i of H is the node order[N - size + i] of G.
+		*/
+		template<typename Graph>
+		void induced(const Graph &G, NodeID size){
+			NodeID N = G.number_of_nodes(), first = N - size;
+			std::vector<EdgeID> offsets = std::vector<EdgeID>(size + 1, 0);
+			std::vector<NodeID> targets = std::vector<NodeID>();
+			for(NodeID i = 0; i < size; ++i){
+				for(NodeID u: G.neighbours(order[first + i])){
+					if(position[u] >= first){ targets.push_back(position[u] - first); }
+				}
+				offsets[i + 1] = targets.size();
+			}
+			H.build_from_csr(offsets, targets);
+		}
+		
+		/*
+		 Method: reinsert
+		 Colors the first N - size nodes in order from the last to the first with the smallest color, which none of their colored neighbours has.
+		 Every such node has less than k colored neighbours, so the color is below k.
+		*/
+		template<typename Graph>
+		void reinsert(const Graph &G, NodeID size, color k, colors &coloring){
+			NodeID N = G.number_of_nodes();
+			nodes used = nodes(k + 1, N);
+			for(NodeID i = N - size; i-- > 0;){
+				NodeID v = order[i];
+				for(NodeID u: G.neighbours(v)){
+					if(position[u] > i && coloring[u] < k){ used[coloring[u]] = v; }
+				}
+				color c = 0;
+				while(used[c] == v){ c++; }
+				coloring[v] = c;
+			}
+		}
+		
+	public:
+		CorePeeling() : prepared(0) {}
+		
+		/*
+		 Method: calculate
+		 Computes the core numbers and the degeneracy order of G, see <ColoringUpperBound::cores>.
+		 The solver is expected to be prepared for the whole graph G.
+		*/
+		template<typename Graph>
+		void calculate(const Graph &G){
+			ColoringUpperBound::cores(G, core, order, position);
+			prepared = G.number_of_nodes();
+		}
+		
+		/*
+		 Method: core_size
+		 Returns the number of nodes with core number at least k, they are the last nodes in order.
+		*/
+		NodeID core_size(color k) const {
+			nodes::const_iterator first = std::partition_point(order.begin(), order.end(), [&](NodeID v){ return core[v] < k; });
+			return order.end() - first;
+		}
+		
+		/*
+		 Method: solve
+		 Solves the k-coloring problem for the coloring of G on the k-core and colors the peeled nodes greedily.
+		 The solver is allocated again only if the size of the core has changed since the last epoch.
+		*/
+		template<typename Graph, typename Solver>
+		colors solve(const Graph &G, Solver &solver, const colors &coloring, color k){
+			NodeID N = G.number_of_nodes(), size = core_size(k), first = N - size;
+			if(size == N){
+				if(prepared != N){ solver.allocate(G, k); }
+				prepared = N;
+				return solver.solve(G, coloring, k);
+			}
+			
+			if(size != prepared){
+				induced(G, size);
+				if(size > 0){ solver.allocate(H, k); }
+				prepared = size;
+			}
+			
+			colors result = coloring;
+			if(size > 0){
+				colors reduced = colors(size);
+				for(NodeID i = 0; i < size; ++i){ reduced[i] = coloring[order[first + i]]; }
+				colors solution = solver.solve(H, reduced, k);
+				for(NodeID i = 0; i < size; ++i){ result[order[first + i]] = solution[i]; }
+			}
+			
+			reinsert(G, size, k, result);
+			return result;
+		}
+	};
+	
 	/*
 	 Class: EpocheRunner
 	 Master of the Guided Local Search
@@ -1560,12 +3416,43 @@ namespace gls {
 	 */
 	class EpocheRunner{
 	private:
+		/*
+		 Field: floor
+		 Colors needed by an already solved component of the graph, the search does not go below them. NULL if the graph is solved as a whole.
+		 */
+		const std::atomic<color>* floor;
+		
+		/*
+		 Field: offset
+		 Colors of the whole graph, which the extracted independent sets already take. The lower bound of the search on the residual graph is smaller by them.
+		 */
+		color offset;
+		
+		/*
+		 Field: summary
+		 Report, to which the solutions of the components are added. NULL if the graph is solved as a whole, then the solution line is printed.
+		 */
+		SolveReport* summary;
+		
+		/*
+		 Field: random
+		 Engine of the merged color classes
+		 */
+		std::mt19937 random;
+		
+		/*
+		 Field: solvers
+		 The solvers with narrow and with wide scores. They stay between the runs, so the next graphs reuse their memory.
+		 */
+		std::tuple<GuidedLocalSearch<delta>, GuidedLocalSearch<wide_delta>> solvers;
+		
 		/*
 		 Method: evaluate
 		 Counts the conflicting nodes in a coloring of a graph G.
 		*/
-		uint evaluate(const graph_access &G, const colors &coloring){
-			uint result = 0;
+		template<typename Graph>
+		scoresum evaluate(const Graph &G, const colors &coloring){
+			scoresum result = 0;
 			NodeID N = G.number_of_nodes();
 			
 			for(NodeID v = 0; v < N; ++v) {
@@ -1581,13 +3468,27 @@ namespace gls {
 			return result;
 		}
 		
+		/*
+		 Method: evaluate
+		 Counts the conflicts of a dense graph as the popcount of every adjacency row with the class of the node.
+		*/
+		scoresum evaluate(const dense_graph &G, const colors &coloring){
+			std::vector<uint64_t> classes;
+			G.node_sets(coloring, get_colors(coloring), classes);
+			scoresum result = 0;
+			NodeID N = G.number_of_nodes();
+			for(NodeID v = 0; v < N; ++v) {
+				result += G.count_neighbours(v, &classes[coloring[v] * G.words()]);
+			}
+			return result / 2;
+		}
+		
 		/*
 		 Method: groups
 		 Finds the number of nodes grouped by color in a given k-coloring.
 		*/
 		colors groups(const colors &coloring, const uint k){
-			uint* groups = new uint[k];
-			for(color i = 0; i < k; i++){ groups[i] = 0; }
+			nodes groups = nodes(k, 0);
 			for(color c: coloring){ groups[c]++; }
 			upairs sorted = upairs(); 
 			for(color i = 0; i < k; i++){ 
@@ -1610,13 +3511,14 @@ namespace gls {
 		 The resulting coloring is granted to have at most k-1 colors, if k is correct.
 		 Otherwise the coloring will be truncated.
 		*/
-		colors filter(const graph_access &G, const colors &coloring, color k){
+		template<typename Graph>
+		colors filter(const Graph &G, const colors &coloring, color k){
 			if(get_colors(coloring) <= k - 1 && evaluate(G, coloring) == 0){
 				return coloring;
 			}
 			
 			if(UPDATE_STRATEGY == EpocheStrategy::Scratch){
-				return ColoringBuilder::random(G, k-1);
+				return ColoringBuilder::random(G, k-1, random);
 			}
 			
 			colors sorted = groups(coloring, k);
@@ -1624,7 +3526,7 @@ namespace gls {
 			color src;
 			switch(SOURCE_TARGET){
 				case EpocheTarget::Random:
-					src = sorted[rand() % k];
+					src = sorted[random() % k];
 					break;
 				case EpocheTarget::Minimal:
 					src = sorted[k-1];
@@ -1643,7 +3545,7 @@ namespace gls {
 			colors result = colors();
 			if(DESTINATION_TARGET == EpocheTarget::Random){
 				for(color c: coloring){
-					while(c == src){ c  = rand() % k; }
+					while(c == src){ c  = random() % k; }
 					if(c > src){c--;}
 					result.push_back(c);
 				}
@@ -1674,26 +3576,154 @@ namespace gls {
 			return result;
 		}
 		
-	public:
-		/*
-		 Method: get_colors
-		 Finds the biggest number in a coloring.
+	    /*
+		 Method: search
+		 Applies the GLS strategy iteratively, trying yo minimize the number of the colors in a given coloring of the graph G.
+		 If the density of G reaches DENSE_THRESHOLD percent, the search runs on the bitset adjacencies of G.
 		*/
-		inline static color get_colors(const colors &coloring){
-			color k = 0;
-			for (color c: coloring){
-				if(k < c){ k = c; }
+		template<typename Graph>
+		colors search(const Graph &G, const colors &coloring){
+			if(DENSE_THRESHOLD && dense_graph::density(G) * 100 >= DENSE_THRESHOLD){
+				dense_graph D(G);
+				return run(D, coloring);
 			}
-			return ++k;
+			return run(G, coloring);
 		}
 		
 	    /*
-		 Method: solve
-		 Applies the GLS strategy iteratively, trying yo minimize the number of the colors in a given coloring of the graph G.
+		 Method: components
+		 Solves every connected component of G on its own and merges the colorings. THREADS workers take the components, the largest first.
+		 The colors of the whole graph are the maximum over the components, so a component stops at the colors of the components solved before.
+		 Every component seeds its runner from its index, and its messages are buffered and printed together. One solution line sums up the components.
+		*/
+		template<typename Graph>
+		colors components(const Graph &G, const colors &coloring){
+			NodeID N = G.number_of_nodes();
+			nodes component = nodes(N, N);
+			nodes members = nodes();
+			members.reserve(N);
+			// the members of component c are members[start[c]] to members[start[c + 1] - 1]
+			nodes start = nodes(1, 0);
+			for(NodeID s = 0; s < N; ++s){
+				if(component[s] != N){ continue; }
+				NodeID c = start.size() - 1, head = members.size();
+				component[s] = c;
+				members.push_back(s);
+				while(head < members.size()){
+					NodeID v = members[head++];
+					for(NodeID u: G.neighbours(v)){
+						if(component[u] == N){
+							component[u] = c;
+							members.push_back(u);
+						}
+					}
+				}
+				std::sort(members.begin() + start[c], members.end());
+				start.push_back(members.size());
+			}
+			
+			NodeID C = start.size() - 1;
+			if(C <= 1){
+				return reorder(G, coloring);
+			}
+			
+			nodes local = nodes(N);
+			for(NodeID c = 0; c < C; ++c){
+				for(NodeID i = start[c]; i < start[c + 1]; ++i){ local[members[i]] = i - start[c]; }
+			}
+			
+			nodes sorted = nodes(C);
+			for(NodeID c = 0; c < C; ++c){ sorted[c] = c; }
+			std::stable_sort(sorted.begin(), sorted.end(), [&](NodeID a, NodeID b){
+				return start[a + 1] - start[a] > start[b + 1] - start[b];
+			});
+			
+			colors result = colors(N, 0);
+			std::atomic<NodeID> next(0);
+			std::atomic<color> solved(0);
+			delta lambda = LAMBDA;
+			// the messages of a component are printed at once after it is solved, the solution line once for the whole graph
+			std::mutex print;
+			SolveReport total = SolveReport();
+			total.prepare(0);
+			parallel::for_each_block(parallel::blocks_for(C, 1), [&](unsigned){
+				LAMBDA = lambda;
+				std::ostringstream messages;
+				SolveReport summary = SolveReport();
+				summary.prepare(0);
+				EpocheRunner runner = EpocheRunner();
+				runner.floor = &solved;
+				runner.offset = offset;
+				runner.summary = &summary;
+				runner.output(messages);
+				
+				for(NodeID i = next++; i < C; i = next++){
+					NodeID c = sorted[i], first = start[c], size = start[c + 1] - first;
+					
+					std::vector<EdgeID> offsets = std::vector<EdgeID>(size + 1, 0);
+					std::vector<NodeID> targets = std::vector<NodeID>();
+					colors part = colors(size);
+					for(NodeID j = 0; j < size; ++j){
+						NodeID v = members[first + j];
+						for(NodeID u: G.neighbours(v)){ targets.push_back(local[u]); }
+						offsets[j + 1] = targets.size();
+						part[j] = coloring[v];
+					}
+					graph_access H;
+					H.build_from_csr(offsets, targets);
+					
+					// the stream of a component does not depend on the worker, which solves it
+					runner.seed(c + 1);
+					colors solution = runner.reorder(H, part);
+					for(NodeID j = 0; j < size; ++j){ result[members[first + j]] = solution[j]; }
+					
+					color k = get_colors(solution), current = solved.load();
+					while(current < k && !solved.compare_exchange_weak(current, k)){}
+					
+					std::lock_guard<std::mutex> lock(print);
+					std::cout << messages.str();
+					messages.str("");
+				}
+				
+				std::lock_guard<std::mutex> lock(print);
+				total.merge(summary);
+			});
+			
+			total.s_K = get_colors(result);
+			total.finish_solution();
+			return result;
+		}
 		
-		 The input graph and coloring are not changed.
+	    /*
+		 Method: reorder
+		 Searches on the graph G relabeled according to REORDER.
+		*/
+		template<typename Graph>
+		colors reorder(const Graph &G, const colors &coloring){
+			if(REORDER == ReorderStrategy::NoReorder){
+				return search(G, coloring);
+			}
+			
+			NodeID N = G.number_of_nodes();
+			nodes order = GraphReorder::calculate(G);
+			graph_access H;
+			GraphReorder::relabel(G, order, H);
+			
+			colors relabeled = colors(N);
+			for(NodeID i = 0; i < N; ++i){ relabeled[i] = coloring[order[i]]; }
+			colors solution = search(H, relabeled);
+			
+			colors result = colors(N);
+			for(NodeID i = 0; i < N; ++i){ result[order[i]] = solution[i]; }
+			return result;
+		}
+		
+	    /*
+		 Method: run
+		 The epoche cycle of search on the chosen graph representation.
 		*/
-		colors solve(const graph_access &G, const colors &coloring){
+		template<typename Graph>
+		colors run(const Graph &G, const colors &coloring){
 			colors bi = ColoringBuilder::bipartite(G);
 			if(evaluate(G, bi) == 0){
 				return bi;
@@ -1701,11 +3731,20 @@ namespace gls {
 			
 			ColoringUpperBound bound = ColoringUpperBound();
 			color K = bound.calculate(G);
-			if(K < get_colors(coloring)){
+			// a coloring without conflicts already solves the epoches down to its number of colors
+			if(K < get_colors(coloring) || evaluate(G, coloring) == 0){
 				K = get_colors(coloring);
 			}
 			
-			if(LOWER_BOUND == 2){LOWER_BOUND++;}
+			color lower = (LOWER_BOUND == 2) ? 3 : LOWER_BOUND;
+			lower = (lower > offset) ? lower - offset : 1;
+			if(CLIQUE_BOUND){
+				// the search stops as soon as it reaches the clique size
+				lower = std::max(lower, ColoringLowerBound::clique(G));
+			}
+			if(SPECTRAL_BOUND){
+				lower = std::max(lower, ColoringLowerBound::spectral(G));
+			}
 			
 			// If the given coloring contains has a color bigger than the upper bound, set it to zero.
 			// This is the case random coloring with 10000 the biggest color and K = 10
@@ -1714,14 +3753,55 @@ namespace gls {
 				if (c >= K){ result.push_back(0); }
 				else{ result.push_back(c); }
 			}
+			
+			if(wide_scores(G)){
+				return epoches<wide_delta>(G, result, K, lower);
+			}
+			return epoches<delta>(G, result, K, lower);
+		}
+		
+	    /*
+		 Method: wide_scores
+		 Tells if the search on G needs the wide scores. The narrow ones are used only if 10 times the maximal degree fits in them.
+		 SCORE_BITS forces the width, otherwise the narrow scores are used if a node can take the expected weight updates
+		 before its weights reach the cap, see <GuidedLocalSearch::weight_cap>. Above it they are rescaled, see <GuidedLocalSearch::rescale_weights>.
+		 The weights of a node grow by about one per millisecond, so TIMEOUT and MAX_ITER bound the updates. Without them the scores are wide.
+		 They are wide also with DYNAMIC_LAMBDA, which sets LAMBDA only during the search.
+		*/
+		template<typename Graph>
+		bool wide_scores(const Graph &G){
+			int64_t D = 0;
+			NodeID N = G.number_of_nodes();
+			for(NodeID v = 0; v < N; ++v){ D = std::max<int64_t>(D, G.getNodeDegree(v)); }
+			int64_t space = (int64_t) std::numeric_limits<delta>::max() - 10 * D;
+			if(space <= 0){ return true; }
+			if(SCORE_BITS){ return SCORE_BITS > 16; }
+			if(DYNAMIC_LAMBDA){ return true; }
+			
+			int64_t updates = std::numeric_limits<int64_t>::max();
+			if(TIMEOUT){ updates = TIMEOUT; }
+			if(MAX_ITER){ updates = std::min<int64_t>(updates, MAX_ITER); }
+			return updates > space / std::max<int64_t>(LAMBDA, 1);
+		}
+		
+	    /*
+		 Method: epoches
+		 Runs the epoches from K colors down to the lower bound with scores of the type T.
+		*/
+		template<typename T, typename Graph>
+		colors epoches(const Graph &G, colors result, color K, color lower){
 			colors filtered = result; 
 			
-			GuidedLocalSearch solver = GuidedLocalSearch();
+			GuidedLocalSearch<T> &solver = std::get<GuidedLocalSearch<T>>(solvers);
 			solver.prepare(G, filtered, K);
 			
+			CorePeeling peeling = CorePeeling();
+			if(PEEL){ peeling.calculate(G); }
+			
 			color k;
-			for (k = K; k >= LOWER_BOUND; k--){
-				colors solution = solver.solve(G, filtered, k);
+			// the first epoche always runs, so the result is a solution even if the bounds are already reached
+			for (k = K; k == K || (k >= lower && (floor == NULL || k >= floor->load())); k--){
+				colors solution = PEEL ? peeling.solve(G, solver, filtered, k) : solver.solve(G, filtered, k);
 				
 				if(evaluate(G, solution) == 0){
 					result = solution;
@@ -1732,7 +3812,99 @@ namespace gls {
 				filtered = filter(G, result, k);
 			}
 			
-			solver.report.finish_solution();
+			if(summary == NULL){
+				solver.report.finish_solution();
+			} else {
+				summary->merge(solver.report);
+			}
+			
+			return result;
+		}
+		
+		/*
+		 Method: residual
+		 Extracts the independent sets, if RLF_RESIDUAL is set and the graph is bigger, and solves the rest with the lower bound reduced by the extracted sets.
+		*/
+		template<typename Graph>
+		colors residual(const Graph &G, const colors &coloring){
+			if(RLF_RESIDUAL == 0 || G.number_of_nodes() <= RLF_RESIDUAL){
+				return COMPONENTS ? components(G, coloring) : reorder(G, coloring);
+			}
+			
+			IndependentSetExtraction extraction = IndependentSetExtraction();
+			graph_access H;
+			extraction.extract(G, H, RLF_RESIDUAL);
+			if(H.number_of_nodes() == 0){
+				return extraction.expand(colors());
+			}
+			
+			colors restricted = extraction.restrict(coloring);
+			offset = extraction.extracted_sets();
+			colors solution = COMPONENTS ? components(H, restricted) : reorder(H, restricted);
+			offset = 0;
+			return extraction.expand(solution);
+		}
+		
+	public:
+		EpocheRunner() : floor(NULL), offset(0), summary(NULL) {
+			seed(0);
+		}
+		
+		/*
+		 Method: seed
+		 Seeds the engines of the runner and of its solvers from SEED and the stream, every component of a graph has its own stream.
+		*/
+		void seed(uint stream){
+			std::seed_seq merges = {SEED, stream, 0u}, moves = {SEED, stream, 1u};
+			random.seed(merges);
+			std::get<GuidedLocalSearch<delta>>(solvers).seed(moves);
+			std::get<GuidedLocalSearch<wide_delta>>(solvers).seed(moves);
+		}
+		
+		/*
+		 Method: output
+		 Writes the messages of the solvers to the stream.
+		*/
+		void output(std::ostream &out){
+			std::get<GuidedLocalSearch<delta>>(solvers).report.out = &out;
+			std::get<GuidedLocalSearch<wide_delta>>(solvers).report.out = &out;
+		}
+		
+		/*
+		 Method: get_colors
+		 Finds the biggest number in a coloring.
+		*/
+		inline static color get_colors(const colors &coloring){
+			color k = 0;
+			for (color c: coloring){
+				if(k < c){ k = c; }
+			}
+			return ++k;
+		}
+		
+	    /*
+		 Method: solve
+		 Applies the GLS strategy iteratively, trying yo minimize the number of the colors in a given coloring of the graph G.
+		 
+		 If REDUCE is set, the dominated nodes are removed first and get the colors of their dominators at the end.
+		 If RLF_RESIDUAL is set, independent sets are extracted next and the search runs only on the residual graph.
+		 If COMPONENTS is set, the connected components are solved in parallel.
+		 If REORDER is set, the search runs on a relabeled copy of the graph and the solution is mapped back to the original node IDs.
+		 
+		 The input graph and coloring are not changed.
+		*/
+		template<typename Graph>
+		colors solve(const Graph &G, const colors &coloring){
+			colors result;
+			if(REDUCE){
+				GraphReduction reduction = GraphReduction();
+				graph_access H;
+				reduction.reduce(G, H);
+				colors restricted = reduction.restrict(coloring);
+				result = reduction.expand(residual(H, restricted));
+			} else {
+				result = residual(G, coloring);
+			}
 			
 			if (DEBUG & DEBUG_OUTPUT){
 				if(evaluate(G, result) == 0){
@@ -1768,7 +3940,12 @@ std::vector<int> GuidedLocalSearch(const std::vector<int> &s, const graph_access
 }
 */
 
-gls::colors GuidedLocalSearch(const gls::colors &s, const graph_access &G){
+/*
+ G may be a graph_access or a graph_view over CSR arrays of the caller, e.g.
+ GuidedLocalSearch(s, graph_view<>(offsets, targets, n)) solves without copying the graph.
+*/
+template<typename Graph>
+gls::colors GuidedLocalSearch(const gls::colors &s, const Graph &G){
 	gls::EpocheRunner solver = gls::EpocheRunner();
 	return solver.solve(G, s);
 }
@@ -22,14 +22,25 @@
 
 #pragma once
 
+#include <algorithm>
 #include <bitset>
 #include <cassert>
 #include <cstdint>
 #include <iostream>
 #include <vector>
 
+#include "mapped_file.h"
+
+// Turn on 64 bit node and edge ids for graphs with more than 2^31 directed edges
+// #define GLS_64BIT 1
+
+#ifdef GLS_64BIT
+typedef uint64_t NodeID;
+typedef uint64_t EdgeID;
+#else
 typedef uint32_t NodeID;
 typedef uint32_t EdgeID;
+#endif
 typedef uint32_t Color;
 
 struct Node {
@@ -48,24 +59,55 @@ class basicGraph {
 
 public:
     basicGraph() : m_building_graph(false) {
+        attach_vectors();
     }
 
 private:
     //methods only to be used by friend class
     EdgeID number_of_edges() {
-        return m_edges.size();
+        return m_edge_count;
     }
 
     NodeID number_of_nodes() {
-        return m_nodes.size() - 1;
+        return m_node_count;
     }
 
     inline EdgeID get_first_edge(const NodeID & node) {
-        return m_nodes[node];
+        return m_node_array[node];
     }
 
     inline EdgeID get_first_invalid_edge(const NodeID & node) {
-        return m_nodes[node + 1];
+        return m_node_array[node + 1];
+    }
+
+    // the access arrays point to the constructed vectors
+    void attach_vectors() {
+        m_node_array = m_nodes.data();
+        m_edge_array = m_edges.data();
+        m_node_count = m_nodes.empty() ? 0 : m_nodes.size() - 1;
+        m_edge_count = m_edges.size();
+    }
+
+    // takes over complete CSR arrays, the arguments are left empty
+    void adopt_vectors(std::vector<EdgeID> & nodes, std::vector<NodeID> & edges) {
+        m_mapping.close();
+        m_nodes.swap(nodes);
+        m_edges.swap(edges);
+        std::vector<EdgeID>().swap(nodes);
+        std::vector<NodeID>().swap(edges);
+        attach_vectors();
+    }
+
+    // the access arrays point into a mapped binary graph, which is owned from now on
+    void attach_mapping(mapped_file & file, const EdgeID* nodes, const NodeID* edges, NodeID n, EdgeID m) {
+        std::vector<EdgeID>().swap(m_nodes);
+        std::vector<NodeID>().swap(m_edges);
+        m_mapping.swap(file);
+
+        m_node_array = nodes;
+        m_edge_array = edges;
+        m_node_count = n;
+        m_edge_count = m;
     }
 
     // construction of the graph
@@ -114,11 +156,12 @@ private:
         m_edges.resize(e);
 
         m_building_graph = false;
+        attach_vectors();
 
         //fill isolated sources at the end
-        if ((unsigned int)(m_last_source) != node - 1) {
+        if ((NodeID)(m_last_source) != node - 1) {
             //in that case at least the last node was an isolated node
-            for (NodeID i = node; i > (unsigned int)(m_last_source + 1); i--) {
+            for (NodeID i = node; i > (NodeID)(m_last_source + 1); i--) {
                 m_nodes[i] = m_nodes[m_last_source + 1];
             }
         }
@@ -129,13 +172,96 @@ private:
     std::vector<EdgeID> m_nodes;
     std::vector<NodeID> m_edges;
 
+    // access arrays, either the vectors above or a read-only mapped file
+    const EdgeID* m_node_array;
+    const NodeID* m_edge_array;
+    NodeID m_node_count;
+    EdgeID m_edge_count;
+    mapped_file m_mapping;
+
     // construction properties
     bool m_building_graph;
-    int m_last_source;
+    int64_t m_last_source;
     NodeID node; //current node that is constructed
     EdgeID e;    //current edge that is constructed
 };
 
+// read-only view of CSR arrays owned by the caller: offsets holds the n + 1 first edges,
+// starting with 0, targets the offsets[n] edge targets; the arrays must outlive the view.
+// It has the access methods of graph_access without the indirection through basicGraph.
+template <typename Node = NodeID, typename Edge = EdgeID>
+class graph_view {
+public:
+    graph_view() : m_offsets(NULL), m_targets(NULL), m_nodes(0) {}
+
+    graph_view(const Edge* offsets, const Node* targets, Node n)
+        :   m_offsets(offsets)
+        ,   m_targets(targets)
+        ,   m_nodes(n)
+    {}
+
+    Node number_of_nodes() const {
+        return m_nodes;
+    }
+
+    Edge number_of_edges() const {
+        return m_nodes ? m_offsets[m_nodes] : 0;
+    }
+
+    Edge get_first_edge(Node node) const {
+        return m_offsets[node];
+    }
+
+    Edge get_first_invalid_edge(Node node) const {
+        return m_offsets[node + 1];
+    }
+
+    Edge getNodeDegree(Node node) const {
+        return m_offsets[node + 1] - m_offsets[node];
+    }
+
+    Edge getMaxDegree() const {
+        Edge max_degree = 0;
+        for (Node node = 0; node < m_nodes; ++node) {
+            max_degree = std::max(max_degree, getNodeDegree(node));
+        }
+        return max_degree;
+    }
+
+    Node getEdgeTarget(Edge edge) const {
+        return m_targets[edge];
+    }
+
+    class adjacency_adapter {
+    public:
+        adjacency_adapter(const Node* _begin, const Node* _end)
+            :   m_begin(_begin)
+            ,   m_end(_end)
+        {}
+
+        const Node* begin() const {
+            return m_begin;
+        }
+
+        const Node* end() const {
+            return m_end;
+        }
+
+    private:
+        const Node* m_begin;
+        const Node* m_end;
+    };
+
+    adjacency_adapter neighbours(Node n) const {
+        return adjacency_adapter(m_targets + m_offsets[n], m_targets + m_offsets[n + 1]);
+    }
+
+private:
+    const Edge* m_offsets;
+    const Node* m_targets;
+    Node m_nodes;
+};
+
 // //makros - graph access
 // #define forall_edges(G,e) { for(EdgeID e = 0, end = G.number_of_edges(); e < end; ++e) {
 // #define forall_nodes(G,n) { for(NodeID n = 0, end = G.number_of_nodes(); n < end; ++n) {
@@ -145,7 +271,7 @@ private:
 class graph_access {
 public:
     graph_access() { m_max_degree_computed = false; m_max_degree = 0; graphref = new basicGraph();}
-    virtual ~graph_access() { delete graphref; };
+    ~graph_access() { delete graphref; };
 
     /* ============================================================= */
     /* build methods */
@@ -155,6 +281,22 @@ public:
     EdgeID new_edge(NodeID source, NodeID target);
     void finish_construction();
 
+    // takes over finished CSR arrays without copying: nodes holds the n + 1 first edge
+    // offsets, edges the targets; both vectors are left empty
+    void build_from_csr(std::vector<EdgeID> & nodes, std::vector<NodeID> & edges);
+
+    /* ============================================================= */
+    /* mapped graph methods */
+    /* ============================================================= */
+    void map_csr(mapped_file & file, const EdgeID* nodes, const NodeID* edges,
+                 NodeID n, EdgeID m, EdgeID max_degree);
+
+    // releases the adjacency arrays or the mapping, the graph has no nodes afterwards
+    void clear();
+
+    // view of the current arrays, valid until the graph is rebuilt or cleared
+    graph_view<> view() const;
+
     /* ============================================================= */
     /* graph access methods */
     /* ============================================================= */
@@ -245,6 +387,31 @@ inline void graph_access::finish_construction() {
     graphref->finish_construction();
 }
 
+inline void graph_access::build_from_csr(std::vector<EdgeID> & nodes, std::vector<NodeID> & edges) {
+    assert(!nodes.empty() && nodes.back() == edges.size());
+    graphref->adopt_vectors(nodes, edges);
+    m_max_degree = 0;
+    m_max_degree_computed = false;
+}
+
+/* mapped graph methods */
+inline void graph_access::map_csr(mapped_file & file, const EdgeID* nodes, const NodeID* edges,
+                                  NodeID n, EdgeID m, EdgeID max_degree) {
+    graphref->attach_mapping(file, nodes, edges, n, m);
+    m_max_degree = max_degree;
+    m_max_degree_computed = true;
+}
+
+inline void graph_access::clear() {
+    std::vector<EdgeID> nodes(1, 0);
+    std::vector<NodeID> edges;
+    build_from_csr(nodes, edges);
+}
+
+inline graph_view<> graph_access::view() const {
+    return graph_view<>(graphref->m_node_array, graphref->m_edge_array, graphref->m_node_count);
+}
+
 /* graph access methods */
 inline NodeID graph_access::number_of_nodes() const {
     return graphref->number_of_nodes();
@@ -255,27 +422,21 @@ inline EdgeID graph_access::number_of_edges() const {
 }
 
 inline EdgeID graph_access::get_first_edge(NodeID node) const {
-#ifdef NDEBUG
-    return graphref->m_nodes[node];
-#else
-    return graphref->m_nodes.at(node);
-#endif
+    assert(node <= graphref->m_node_count);
+    return graphref->m_node_array[node];
 }
 
 inline EdgeID graph_access::get_first_invalid_edge(NodeID node) const {
-    return graphref->m_nodes[node + 1];
+    return graphref->m_node_array[node + 1];
 }
 
 inline NodeID graph_access::getEdgeTarget(EdgeID edge) const {
-#ifdef NDEBUG
-    return graphref->m_edges[edge];
-#else
-    return graphref->m_edges.at(edge);
-#endif
+    assert(edge < graphref->m_edge_count);
+    return graphref->m_edge_array[edge];
 }
 
 inline EdgeID graph_access::getNodeDegree(NodeID node) const {
-    return graphref->m_nodes[node + 1] - graphref->m_nodes[node];
+    return graphref->m_node_array[node + 1] - graphref->m_node_array[node];
 }
 
 inline EdgeID graph_access::getMaxDegree() {
@@ -22,127 +22,776 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <ostream>
 #include <cstdio>
 #include <cstdlib>
-#include <sstream>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "graph.h"
+#include "mapped_file.h"
+#include "parallel.h"
+
+// Binary CSR graph file: this header followed by the (n + 1) first edge offsets
+// and the m edge targets, each array starting at an 8 byte aligned offset.
+// The file is stored in the native byte order of the machine, which wrote it.
+struct binary_graph_header {
+    char     magic[4];       // "GLSB"
+    uint32_t version;
+    uint32_t node_id_bytes;  // sizeof(NodeID) of the writer
+    uint32_t edge_id_bytes;  // sizeof(EdgeID) of the writer
+    uint64_t nodes;
+    uint64_t edges;          // directed edges, i.e. twice the undirected ones
+    uint64_t max_degree;
+    uint64_t checksum;       // of both arrays, see binary_checksum
+};
+
+// Flags from the METIS header line
+struct metis_format {
+    bool read_ew = false;
+    bool read_nw = false;
+};
+
+// Line aligned piece of a METIS file, parsed by one thread
+struct metis_chunk {
+    const char* begin = NULL;
+    const char* end   = NULL;
+    NodeID nodes      = 0;
+    EdgeID edges      = 0;
+    NodeID first_node = 0;
+    EdgeID first_edge = 0;
+    long long nodeweight = 0;
+    bool self_loops   = false;
+};
+
+// Header data of a DIMACS .col file
+struct dimacs_info {
+    NodeID declared_nodes = 0;   // from the "p edge n m" line
+    std::string min = "2";       // known lower bound from an optional "min x" line
+    std::string comment;         // "c" lines, one per line
+};
+
+// Input formats of readGraph
+enum class graph_format { metis, binary, edge_list, matrix_market, dimacs };
+
+const char     BINARY_GRAPH_MAGIC[4] = { 'G', 'L', 'S', 'B' };
+const uint32_t BINARY_GRAPH_VERSION  = 1;
 
 class graph_io {
 public:
     graph_io();
     virtual ~graph_io () ;
 
+    // reads the graph in the format of the file extension, see format_of
+    static int readGraph(graph_access& G, std::string filename);
+    static int readGraph(graph_access& G, std::string filename, graph_format format);
+
+    // .bin binary, .mtx Matrix Market, .el .edges .snap .txt edge list, .col DIMACS, otherwise METIS.
+    // A file with the binary magic is read as binary under any name.
+    static graph_format format_of(const std::string& filename);
+
     static int readGraphWeighted(graph_access& G, std::string filename);
+
+    // validates the header and the sizes, the checksum of the arrays only with verify, since it reads every page of the file
+    static int readGraphBinary(graph_access& G, std::string filename, bool verify = false);
+    static int writeGraphBinary(graph_access& G, std::string filename);
+
+    static int readGraphDimacs(graph_access& G, std::string filename, dimacs_info& info);
+
+    // SNAP style edge list: one "u v" pair of 0-based nodes per line, '#' or '%' comments
+    static int readGraphEdgeList(graph_access& G, std::string filename);
+    // Matrix Market coordinate file, the nonzero pattern is read as an undirected graph
+    static int readGraphMatrixMarket(graph_access& G, std::string filename);
+    static int writeGraphWeighted(graph_access& G, std::string filename);
+
+    // builds an undirected graph from an edge list: the edges are symmetrized, then
+    // self-loops and duplicates are removed; the list is consumed
+    static void buildGraphFromEdges(graph_access& G, NodeID n, std::vector<std::pair<NodeID, NodeID>>& edges);
+
+private:
+    static std::vector<std::pair<const char*, const char*>> split_lines(const char* begin, const char* end);
+    static int readEdgeLines(graph_access& G, const char* begin, const char* end, NodeID base, NodeID n);
+    static const char* line_end(const char* pos, const char* end);
+    static const char* next_line(const char* pos, const char* end);
+    template <typename T>
+    static bool parse_number(const char* & pos, const char* end, T & value);
+    static void count_chunk(metis_chunk & C, const metis_format & format);
+    static void fill_chunk(metis_chunk & C, const metis_format & format, EdgeID* nodes, NodeID* edges);
+
+    static uint64_t binary_checksum(const char* data, size_t bytes, uint64_t hash);
+
+    static size_t binary_padding(size_t bytes) {
+        return (8 - bytes % 8) % 8;
+    }
 };
 
-int graph_io::readGraphWeighted(graph_access & G, std::string filename) {
-    std::string line;
+inline graph_format graph_io::format_of(const std::string & filename) {
+    // the magic has four bytes and a METIS file starts with a digit or a comment, so it can not be mistaken
+    char magic[sizeof(BINARY_GRAPH_MAGIC)] = { 0 };
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    if (in && in.read(magic, sizeof(magic)) && memcmp(magic, BINARY_GRAPH_MAGIC, sizeof(magic)) == 0) {
+        return graph_format::binary;
+    }
+
+    size_t dot = filename.find_last_of("./\\");
+    std::string extension = (dot == std::string::npos || filename[dot] != '.') ? "" : filename.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+    if (extension == "bin") {
+        return graph_format::binary;
+    }
+    if (extension == "mtx") {
+        return graph_format::matrix_market;
+    }
+    if (extension == "el" || extension == "edges" || extension == "snap" || extension == "txt") {
+        return graph_format::edge_list;
+    }
+    if (extension == "col") {
+        return graph_format::dimacs;
+    }
+    return graph_format::metis;
+}
 
-    // open file for reading
-    std::ifstream in(filename.c_str());
-    if (!in) {
+inline int graph_io::readGraph(graph_access & G, std::string filename) {
+    return readGraph(G, filename, format_of(filename));
+}
+
+inline int graph_io::readGraph(graph_access & G, std::string filename, graph_format format) {
+    switch (format) {
+        case graph_format::binary:
+            return readGraphBinary(G, filename);
+        case graph_format::edge_list:
+            return readGraphEdgeList(G, filename);
+        case graph_format::matrix_market:
+            return readGraphMatrixMarket(G, filename);
+        case graph_format::dimacs: {
+            dimacs_info info;
+            return readGraphDimacs(G, filename, info);
+        }
+        default:
+            return readGraphWeighted(G, filename);
+    }
+}
+
+// FNV-1a over 64 bit words, the tail is padded with zeros
+inline uint64_t graph_io::binary_checksum(const char* data, size_t bytes, uint64_t hash) {
+    const uint64_t prime = 1099511628211ULL;
+    size_t words = bytes / sizeof(uint64_t);
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t w;
+        memcpy(&w, data + i * sizeof(uint64_t), sizeof(uint64_t));
+        hash = (hash ^ w) * prime;
+    }
+
+    size_t rest = bytes % sizeof(uint64_t);
+    if (rest) {
+        uint64_t w = 0;
+        memcpy(&w, data + words * sizeof(uint64_t), rest);
+        hash = (hash ^ w) * prime;
+    }
+    return hash;
+}
+
+inline int graph_io::readGraphBinary(graph_access & G, std::string filename, bool verify) {
+    mapped_file file;
+    if (!file.open(filename)) {
         std::cerr << "Error opening " << filename << std::endl;
         return 1;
     }
 
-    long nmbNodes;
-    long nmbEdges;
+    binary_graph_header header;
+    if (file.size() < sizeof(header)) {
+        std::cerr << "The binary graph file is truncated." << std::endl;
+        return 1;
+    }
+    memcpy(&header, file.data(), sizeof(header));
 
-    std::getline(in, line);
-    //skip comments
-    while ( line[0] == '%' ) {
-        std::getline(in, line);
+    if (memcmp(header.magic, BINARY_GRAPH_MAGIC, sizeof(header.magic)) != 0) {
+        std::cerr << filename << " is not a binary graph file." << std::endl;
+        return 1;
     }
 
-    int ew = 0;
-    std::stringstream ss(line);
-    ss >> nmbNodes;
-    ss >> nmbEdges;
-    ss >> ew;
+    if (header.version != BINARY_GRAPH_VERSION) {
+        std::cerr << "Unsupported binary graph version " << header.version << "." << std::endl;
+        return 1;
+    }
 
-    if ( 2 * nmbEdges > std::numeric_limits<int>::max() || nmbNodes > std::numeric_limits<int>::max()) {
-        std::cerr <<  "The graph is too large. Currently only 32bit supported!"  << std::endl;
-        exit(0);
+    if (header.node_id_bytes != sizeof(NodeID) || header.edge_id_bytes != sizeof(EdgeID)) {
+        std::cerr << "The binary graph was written with " << 8 * header.node_id_bytes << "bit node and "
+                  << 8 * header.edge_id_bytes << "bit edge ids. Please convert it again." << std::endl;
+        return 1;
     }
 
-    bool read_ew = false;
-    bool read_nw = false;
+    if (header.nodes > std::numeric_limits<NodeID>::max() - 1 || header.edges > std::numeric_limits<EdgeID>::max()) {
+        std::cerr << "The graph is too large for the node and edge id types." << std::endl;
+        return 1;
+    }
+
+    size_t node_offset = sizeof(header) + binary_padding(sizeof(header));
+    size_t node_bytes  = (header.nodes + 1) * sizeof(EdgeID);
+    size_t edge_offset = node_offset + node_bytes + binary_padding(node_bytes);
+    size_t edge_bytes  = header.edges * sizeof(NodeID);
+
+    if (file.size() < edge_offset + edge_bytes) {
+        std::cerr << "The binary graph file is truncated." << std::endl;
+        return 1;
+    }
+
+    if (verify) {
+        uint64_t checksum = binary_checksum(file.data() + node_offset, node_bytes, 14695981039346656037ULL);
+        checksum = binary_checksum(file.data() + edge_offset, edge_bytes, checksum);
+        if (checksum != header.checksum) {
+            std::cerr << "Checksum mismatch in " << filename << ". The binary graph file is corrupted." << std::endl;
+            return 1;
+        }
+    }
+
+    const EdgeID* nodes = reinterpret_cast<const EdgeID*>(file.data() + node_offset);
+    const NodeID* edges = reinterpret_cast<const NodeID*>(file.data() + edge_offset);
+    if (nodes[0] != 0 || nodes[header.nodes] != header.edges) {
+        std::cerr << "The binary graph file has inconsistent edge offsets." << std::endl;
+        return 1;
+    }
+
+    G.map_csr(file, nodes, edges, (NodeID) header.nodes, (EdgeID) header.edges, (EdgeID) header.max_degree);
+    return 0;
+}
+
+inline int graph_io::writeGraphBinary(graph_access & G, std::string filename) {
+    NodeID n = G.number_of_nodes();
+    EdgeID m = G.number_of_edges();
+
+    std::vector<EdgeID> nodes(n + 1);
+    std::vector<NodeID> edges(m);
+    for (NodeID node = 0; node < n; ++node) {
+        nodes[node] = G.get_first_edge(node);
+    }
+    nodes[n] = m;
+    for (EdgeID e = 0; e < m; ++e) {
+        edges[e] = G.getEdgeTarget(e);
+    }
+
+    size_t node_bytes = nodes.size() * sizeof(EdgeID);
+    size_t edge_bytes = edges.size() * sizeof(NodeID);
+
+    binary_graph_header header;
+    memcpy(header.magic, BINARY_GRAPH_MAGIC, sizeof(header.magic));
+    header.version       = BINARY_GRAPH_VERSION;
+    header.node_id_bytes = sizeof(NodeID);
+    header.edge_id_bytes = sizeof(EdgeID);
+    header.nodes         = n;
+    header.edges         = m;
+    header.max_degree    = G.getMaxDegree();
+    header.checksum      = binary_checksum(reinterpret_cast<const char*>(nodes.data()), node_bytes, 14695981039346656037ULL);
+    header.checksum      = binary_checksum(reinterpret_cast<const char*>(edges.data()), edge_bytes, header.checksum);
+
+    std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Error opening " << filename << std::endl;
+        return 1;
+    }
+
+    const char zeros[8] = { 0 };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(zeros, binary_padding(sizeof(header)));
+    out.write(reinterpret_cast<const char*>(nodes.data()), node_bytes);
+    out.write(zeros, binary_padding(node_bytes));
+    out.write(reinterpret_cast<const char*>(edges.data()), edge_bytes);
+
+    if (!out) {
+        std::cerr << "Error writing " << filename << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Reads a METIS graph. The file is mapped and split into line aligned chunks, which are
+// parsed on their own threads: a first pass counts the nodes and edges of every chunk,
+// a prefix sum over the counts gives each chunk its place in the CSR arrays, and a second
+// pass writes the offsets and targets there directly.
+inline int graph_io::readGraphWeighted(graph_access & G, std::string filename) {
+    mapped_file file;
+    if (!file.open(filename)) {
+        std::cerr << "Error opening " << filename << std::endl;
+        return 1;
+    }
+
+    const char* begin = file.data();
+    const char* end   = begin + file.size();
+
+    //skip comments
+    const char* line = begin;
+    while (line < end && *line == '%') {
+        line = next_line(line, end);
+    }
+
+    long long nmbNodes = 0;
+    long long nmbEdges = 0;
+    long long ew       = 0;
 
-    if (ew == 1) {
-        read_ew = true;
-    } else if (ew == 11) {
-        read_ew = true;
-        read_nw = true;
-    } else if (ew == 10) {
-        read_nw = true;
+    const char* header_end = line_end(line, end);
+    const char* pos = line;
+    parse_number(pos, header_end, nmbNodes);
+    parse_number(pos, header_end, nmbEdges);
+    parse_number(pos, header_end, ew);
+
+    // the signed limits keep -1 free as an invalid id
+    if ( 2 * nmbEdges > (long long) std::numeric_limits<typename std::make_signed<EdgeID>::type>::max()
+         || nmbNodes > (long long) std::numeric_limits<typename std::make_signed<NodeID>::type>::max()) {
+#ifdef GLS_64BIT
+        std::cerr <<  "The graph is too large."  << std::endl;
+#else
+        std::cerr <<  "The graph is too large. Currently only 32bit supported, build with GLS_64BIT for larger graphs!"  << std::endl;
+#endif
+        return 1;
     }
+
+    metis_format format;
+    format.read_ew = (ew == 1 || ew == 11);
+    format.read_nw = (ew == 10 || ew == 11);
+
     nmbEdges *= 2; //since we have forward and backward edges
 
-    NodeID node_counter   = 0;
-    EdgeID edge_counter   = 0;
+    std::vector<std::pair<const char*, const char*>> pieces = split_lines(next_line(line, end), end);
+    unsigned chunks = pieces.size();
+    std::vector<metis_chunk> C(chunks);
+    for (unsigned c = 0; c < chunks; ++c) {
+        C[c].begin = pieces[c].first;
+        C[c].end   = pieces[c].second;
+    }
+
+    parallel::for_each_block(chunks, [&](unsigned c) {
+        count_chunk(C[c], format);
+    });
+
+    NodeID node_counter = 0;
+    EdgeID edge_counter = 0;
     long long total_nodeweight = 0;
+    for (unsigned c = 0; c < chunks; ++c) {
+        C[c].first_node = node_counter;
+        C[c].first_edge = edge_counter;
+        node_counter += C[c].nodes;
+        edge_counter += C[c].edges;
+        total_nodeweight += C[c].nodeweight;
+    }
+
+    if ( (unsigned long long) total_nodeweight > std::numeric_limits<NodeID>::max()) {
+        std::cerr <<  "The sum of the node weights is too large (it exceeds the node weight type)."  << std::endl;
+        std::cerr <<  "Currently not supported. Please scale your node weights."  << std::endl;
+        return 1;
+    }
+
+    if ( edge_counter != (EdgeID) nmbEdges ) {
+        std::cerr <<  "number of specified edges mismatch"  << std::endl;
+        std::cerr <<  edge_counter <<  " " <<  nmbEdges  << std::endl;
+        return 1;
+    }
+
+    if ( node_counter != (NodeID) nmbNodes) {
+        std::cerr <<  "number of specified nodes mismatch"  << std::endl;
+        std::cerr <<  node_counter <<  " " <<  nmbNodes  << std::endl;
+        return 1;
+    }
+
+    std::vector<EdgeID> nodes(node_counter + 1);
+    std::vector<NodeID> edges(edge_counter);
+    parallel::for_each_block(chunks, [&](unsigned c) {
+        fill_chunk(C[c], format, nodes.data(), edges.data());
+    });
+    nodes[node_counter] = edge_counter;
+
+    for (unsigned c = 0; c < chunks; ++c) {
+        if (C[c].self_loops) {
+            std::cerr << "The graph file contains self-loops. This is not supported. Please remove them from the file."  << std::endl;
+            break;
+        }
+    }
+
+    G.build_from_csr(nodes, edges);
+    return 0;
+}
 
-    G.start_construction(nmbNodes, nmbEdges);
+// Streams a DIMACS .col file: "c" comment lines, a "p edge n m" line, "e u v" edges with
+// 1-based nodes and an optional "min x" line with a known lower bound of the coloring.
+// Edges may be given in both directions and more than once.
+inline int graph_io::readGraphDimacs(graph_access & G, std::string filename, dimacs_info & info) {
+    mapped_file file;
+    if (!file.open(filename)) {
+        std::cerr << "Error opening " << filename << std::endl;
+        return 1;
+    }
 
-    while (  std::getline(in, line)) {
+    const char* end = file.data() + file.size();
+    std::vector<std::pair<NodeID, NodeID>> edges;
+    NodeID n = 0;
 
-        if (line[0] == '%') { // a comment in the file
+    for (const char* line = file.data(); line < end; line = next_line(line, end)) {
+        const char* until = line_end(line, end);
+        const char* pos = line;
+        while (pos < until && (*pos == ' ' || *pos == '\t')) {
+            ++pos;
+        }
+        if (pos == until) {
             continue;
         }
 
-        NodeID node = G.new_node();
-        node_counter++;
-        std::stringstream ss(line);
+        char kind = *pos++;
+        if (kind == 'e') {
+            NodeID u, v;
+            if (!parse_number(pos, until, u) || !parse_number(pos, until, v) || u == 0 || v == 0) {
+                std::cerr << "Invalid edge line in " << filename << ": " << std::string(line, until) << std::endl;
+                return 1;
+            }
+            edges.push_back(std::make_pair(u - 1, v - 1));
+            n = std::max(n, std::max(u, v));
+        } else if (kind == 'p') {
+            // "p edge n m" or "p col n m"
+            while (pos < until && *pos != ' ' && *pos != '\t') { ++pos; } // 'p'
+            while (pos < until && (*pos == ' ' || *pos == '\t')) { ++pos; }
+            while (pos < until && *pos != ' ' && *pos != '\t') { ++pos; } // format
+            EdgeID declared_edges = 0;
+            parse_number(pos, until, info.declared_nodes);
+            parse_number(pos, until, declared_edges);
+            edges.reserve(declared_edges);
+        } else if (kind == 'c' && (pos == until || *pos == ' ' || *pos == '\t' || *pos == '\r')) {
+            // comments are kept with collapsed spaces
+            std::string comment;
+            for (const char* c = pos; c < until; ++c) {
+                if (*c == '\r') { continue; }
+                if (*c == ' ' && (comment.empty() || comment.back() == ' ')) { continue; }
+                comment.push_back(*c);
+            }
+            while (!comment.empty() && comment.back() == ' ') {
+                comment.pop_back();
+            }
+            if (!comment.empty()) {
+                info.comment += comment + "\n";
+            }
+        } else if (kind == 'm' && until - pos >= 3 && std::string(pos, pos + 3) == "in ") {
+            pos += 3;
+            long min = 0;
+            if (parse_number(pos, until, min)) {
+                info.min = std::to_string(min);
+            }
+        }
+    }
 
-        NodeID weight = 1;
-        if ( read_nw ) {
-            ss >> weight;
-            total_nodeweight += weight;
-            if ( total_nodeweight > (long long) std::numeric_limits<NodeID>::max()) {
-                std::cerr <<  "The sum of the node weights is too large (it exceeds the node weight type)."  << std::endl;
-                std::cerr <<  "Currently not supported. Please scale your node weights."  << std::endl;
-                exit(0);
+    buildGraphFromEdges(G, std::max(n, info.declared_nodes), edges);
+    return 0;
+}
+
+// Builds the CSR arrays directly from the edge list: the symmetrized list is radix sorted
+// by (source, target) in parallel, then every block counts the edges it keeps and a prefix
+// sum over the blocks gives their positions in the target array.
+inline void graph_io::buildGraphFromEdges(graph_access & G, NodeID n, std::vector<std::pair<NodeID, NodeID>> & edges) {
+    // symmetrize without self-loops, a prefix sum over the proper edges of every block places them
+    size_t given = edges.size();
+    unsigned blocks = parallel::blocks_for(given, 1 << 16);
+    std::vector<size_t> proper(blocks + 1, 0);
+    parallel::for_each_block(blocks, [&](unsigned b) {
+        for (size_t i = given * b / blocks, until = given * (b + 1) / blocks; i < until; ++i) {
+            if (edges[i].first != edges[i].second) {
+                proper[b + 1]++;
             }
         }
+    });
+    for (unsigned b = 0; b < blocks; ++b) {
+        proper[b + 1] += proper[b];
+    }
 
-        NodeID target;
-        while ( ss >> target ) {
-            //check for self-loops
-            if (target - 1 == node) {
-                std::cerr << "The graph file contains self-loops. This is not supported. Please remove them from the file."  << std::endl;
-			}
+    std::vector<std::pair<NodeID, NodeID>> both(2 * proper[blocks]);
+    parallel::for_each_block(blocks, [&](unsigned b) {
+        size_t pos = 2 * proper[b];
+        for (size_t i = given * b / blocks, until = given * (b + 1) / blocks; i < until; ++i) {
+            if (edges[i].first != edges[i].second) {
+                both[pos++] = edges[i];
+                both[pos++] = std::make_pair(edges[i].second, edges[i].first);
+            }
+        }
+    });
+    std::vector<std::pair<NodeID, NodeID>>().swap(edges);
 
-            EdgeID edge_weight = 1;
-            if ( read_ew ) {
-                ss >> edge_weight;
+    unsigned bits = 1;
+    while (bits < 8 * sizeof(NodeID) && (NodeID(1) << bits) < n) {
+        bits++;
+    }
+    parallel::radix_sort(both, [](const std::pair<NodeID, NodeID> & edge) { return edge.second; }, bits);
+    parallel::radix_sort(both, [](const std::pair<NodeID, NodeID> & edge) { return edge.first; }, bits);
+
+    // an edge is kept, if it differs from its predecessor
+    size_t size = both.size();
+    blocks = parallel::blocks_for(size, 1 << 16);
+    std::vector<EdgeID> kept(blocks + 1, 0);
+    parallel::for_each_block(blocks, [&](unsigned b) {
+        for (size_t i = size * b / blocks, until = size * (b + 1) / blocks; i < until; ++i) {
+            if (i == 0 || both[i] != both[i - 1]) {
+                kept[b + 1]++;
             }
-            edge_counter++;
-            EdgeID e = G.new_edge(node, target - 1);
         }
+    });
+    for (unsigned b = 0; b < blocks; ++b) {
+        kept[b + 1] += kept[b];
+    }
 
-        if (in.eof()) {
-            break;
+    const EdgeID unset = std::numeric_limits<EdgeID>::max();
+    std::vector<EdgeID> nodes(n + 1, unset);
+    std::vector<NodeID> targets(kept[blocks]);
+    parallel::for_each_block(blocks, [&](unsigned b) {
+        EdgeID e = kept[b];
+        for (size_t i = size * b / blocks, until = size * (b + 1) / blocks; i < until; ++i) {
+            if (i > 0 && both[i] == both[i - 1]) {
+                continue;
+            }
+            if (i == 0 || both[i].first != both[i - 1].first) {
+                nodes[both[i].first] = e;
+            }
+            targets[e++] = both[i].second;
+        }
+    });
+    std::vector<std::pair<NodeID, NodeID>>().swap(both);
+
+    // sources without edges start where their successor starts
+    nodes[n] = targets.size();
+    for (NodeID node = n; node-- > 0; ) {
+        if (nodes[node] == unset) {
+            nodes[node] = nodes[node + 1];
         }
     }
 
-    if ( edge_counter != (EdgeID) nmbEdges ) {
-        std::cerr <<  "number of specified edges mismatch"  << std::endl;
-        std::cerr <<  edge_counter <<  " " <<  nmbEdges  << std::endl;
-        exit(0);
+    G.build_from_csr(nodes, targets);
+}
+
+inline int graph_io::writeGraphWeighted(graph_access & G, std::string filename) {
+    std::ofstream out(filename.c_str());
+    if (!out) {
+        std::cerr << "Error opening " << filename << std::endl;
+        return 1;
     }
 
-    if ( node_counter != (NodeID) nmbNodes) {
-        std::cerr <<  "number of specified nodes mismatch"  << std::endl;
-        std::cerr <<  node_counter <<  " " <<  nmbNodes  << std::endl;
-        exit(0);
+    out << G.number_of_nodes() << " " << G.number_of_edges() / 2 << "\n";
+    std::string line;
+    char number[24];
+    for (NodeID node = 0; node < G.number_of_nodes(); ++node) {
+        line.clear();
+        for (NodeID target : G.neighbours(node)) {
+            std::to_chars_result result = std::to_chars(number, number + sizeof(number), target + 1);
+            if (!line.empty()) {
+                line.push_back(' ');
+            }
+            line.append(number, result.ptr);
+        }
+        line.push_back('\n');
+        out << line;
+    }
+
+    if (!out) {
+        std::cerr << "Error writing " << filename << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+inline int graph_io::readGraphEdgeList(graph_access & G, std::string filename) {
+    mapped_file file;
+    if (!file.open(filename)) {
+        std::cerr << "Error opening " << filename << std::endl;
+        return 1;
+    }
+    return readEdgeLines(G, file.data(), file.data() + file.size(), 0, 0);
+}
+
+inline int graph_io::readGraphMatrixMarket(graph_access & G, std::string filename) {
+    mapped_file file;
+    if (!file.open(filename)) {
+        std::cerr << "Error opening " << filename << std::endl;
+        return 1;
+    }
+
+    const char* end = file.data() + file.size();
+    const char* line = file.data();
+    std::string banner(line, line_end(line, end));
+    if (banner.find("coordinate") == std::string::npos) {
+        std::cerr << "Only Matrix Market coordinate files are supported." << std::endl;
+        return 1;
     }
 
+    //skip comments
+    while (line < end && *line == '%') {
+        line = next_line(line, end);
+    }
+
+    NodeID rows = 0, cols = 0;
+    EdgeID nonzeros = 0;
+    const char* until = line_end(line, end);
+    const char* pos = line;
+    if (!parse_number(pos, until, rows) || !parse_number(pos, until, cols) || !parse_number(pos, until, nonzeros)) {
+        std::cerr << "Invalid Matrix Market size line in " << filename << std::endl;
+        return 1;
+    }
+
+    // entries are 1-based, values are ignored and the diagonal is dropped as self-loops
+    return readEdgeLines(G, next_line(line, end), end, 1, std::max(rows, cols));
+}
+
+// Parses "u v ..." lines in parallel, every piece of the file into its own list,
+// which are concatenated at offsets from a prefix sum over their sizes.
+inline int graph_io::readEdgeLines(graph_access & G, const char* begin, const char* end, NodeID base, NodeID n) {
+    std::vector<std::pair<const char*, const char*>> pieces = split_lines(begin, end);
+    unsigned chunks = pieces.size();
+    std::vector<std::vector<std::pair<NodeID, NodeID>>> lists(chunks);
+    std::vector<NodeID> nodes(chunks, n);
+    std::vector<const char*> invalid(chunks, (const char*) NULL);
+
+    parallel::for_each_block(chunks, [&](unsigned c) {
+        const char* piece_end = pieces[c].second;
+        for (const char* line = pieces[c].first; line < piece_end; line = next_line(line, piece_end)) {
+            const char* until = line_end(line, piece_end);
+            const char* pos = line;
+            while (pos < until && (*pos == ' ' || *pos == '\t' || *pos == '\r')) {
+                ++pos;
+            }
+            if (pos == until || *pos == '#' || *pos == '%') {
+                continue;
+            }
+
+            NodeID u, v;
+            if (!parse_number(pos, until, u) || !parse_number(pos, until, v) || u < base || v < base) {
+                invalid[c] = line;
+                return;
+            }
+            u -= base;
+            v -= base;
+            lists[c].push_back(std::make_pair(u, v));
+            nodes[c] = std::max(nodes[c], std::max(u, v) + 1);
+        }
+    });
+
+    std::vector<size_t> offsets(chunks + 1, 0);
+    for (unsigned c = 0; c < chunks; ++c) {
+        if (invalid[c] != NULL) {
+            std::cerr << "Invalid edge line: " << std::string(invalid[c], line_end(invalid[c], end)) << std::endl;
+            return 1;
+        }
+        offsets[c + 1] = offsets[c] + lists[c].size();
+        n = std::max(n, nodes[c]);
+    }
 
-    G.finish_construction();
+    std::vector<std::pair<NodeID, NodeID>> edges(offsets[chunks]);
+    parallel::for_each_block(chunks, [&](unsigned c) {
+        std::copy(lists[c].begin(), lists[c].end(), edges.begin() + offsets[c]);
+        std::vector<std::pair<NodeID, NodeID>>().swap(lists[c]);
+    });
+
+    buildGraphFromEdges(G, n, edges);
     return 0;
 }
+
+// splits [begin, end) into line aligned pieces of at least a megabyte, one per thread
+inline std::vector<std::pair<const char*, const char*>> graph_io::split_lines(const char* begin, const char* end) {
+    unsigned chunks = parallel::blocks_for(end - begin, 1 << 20);
+    std::vector<std::pair<const char*, const char*>> pieces(chunks);
+    for (unsigned c = 0; c < chunks; ++c) {
+        const char* from  = (c == 0) ? begin : pieces[c - 1].second;
+        const char* until = (c + 1 == chunks) ? end : begin + (end - begin) * (c + 1) / chunks;
+        if (until < from) {
+            until = from;
+        }
+        if (until != end && until != from && until[-1] != '\n') {
+            until = next_line(until, end);
+        }
+        pieces[c] = std::make_pair(from, until);
+    }
+    return pieces;
+}
+
+inline const char* graph_io::line_end(const char* pos, const char* end) {
+    const char* found = static_cast<const char*>(memchr(pos, '\n', end - pos));
+    return found ? found : end;
+}
+
+inline const char* graph_io::next_line(const char* pos, const char* end) {
+    const char* found = line_end(pos, end);
+    return (found < end) ? found + 1 : end;
+}
+
+// parses the next number in [pos, end), returns false if there is none left on the line
+template <typename T>
+inline bool graph_io::parse_number(const char* & pos, const char* end, T & value) {
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) {
+        ++pos;
+    }
+    std::from_chars_result result = std::from_chars(pos, end, value);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    pos = result.ptr;
+    return true;
+}
+
+inline void graph_io::count_chunk(metis_chunk & C, const metis_format & format) {
+    for (const char* line = C.begin; line < C.end; line = next_line(line, C.end)) {
+        if (*line == '%') { // a comment in the file
+            continue;
+        }
+
+        C.nodes++;
+        const char* pos = line;
+        const char* until = line_end(line, C.end);
+
+        NodeID weight = 1;
+        if (format.read_nw && parse_number(pos, until, weight)) {
+            C.nodeweight += weight;
+        }
+
+        NodeID target;
+        EdgeID edge_weight;
+        while (parse_number(pos, until, target)) {
+            if (format.read_ew) {
+                parse_number(pos, until, edge_weight);
+            }
+            C.edges++;
+        }
+    }
+}
+
+inline void graph_io::fill_chunk(metis_chunk & C, const metis_format & format, EdgeID* nodes, NodeID* edges) {
+    NodeID node = C.first_node;
+    EdgeID e    = C.first_edge;
+    for (const char* line = C.begin; line < C.end; line = next_line(line, C.end)) {
+        if (*line == '%') { // a comment in the file
+            continue;
+        }
+
+        nodes[node] = e;
+        const char* pos = line;
+        const char* until = line_end(line, C.end);
+
+        NodeID weight;
+        if (format.read_nw) {
+            parse_number(pos, until, weight);
+        }
+
+        NodeID target;
+        EdgeID edge_weight;
+        while (parse_number(pos, until, target)) {
+            //check for self-loops
+            if (target - 1 == node) {
+                C.self_loops = true;
+            }
+
+            if (format.read_ew) {
+                parse_number(pos, until, edge_weight);
+            }
+            edges[e++] = target - 1;
+        }
+        node++;
+    }
+}
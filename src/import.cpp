@@ -0,0 +1,141 @@
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#include "../data_structure/graph.h"
+#include "../data_structure/io/graph_io.h"
+#include "../coloring/gls.h"
+
+/*
+ Imports a DIMACS .col graph to the coloring database in one pass:
+ converts it, calculates the statistics and bounds, colors it with GLS and
+ appends the row to graphs.csv.
+
+ Usage: import.exe source.col target coloring graphs.csv group name [--binary]
+
+ The GLS configuration is read from gls.ini, LOWER_BOUND is taken from the "min" line of the source.
+*/
+
+static std::string format_double(double value){
+	char buffer[32];
+	std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	std::string text(buffer, result.ptr);
+	if(text.find_first_of(".e") == std::string::npos){ text += ".0"; }
+	return text;
+}
+
+static int write_coloring(const graph_access &G, const gls::colors &coloring, std::string filename){
+	std::ofstream out(filename.c_str());
+	if(!out){
+		std::cerr << "Error opening " << filename << std::endl;
+		return 1;
+	}
+
+	NodeID N = G.number_of_nodes();
+	out << N << " " << G.number_of_edges() << "\n";
+	for(NodeID v = 0; v < N; v++){
+		out << coloring[v] << " ";
+		for(NodeID u: G.neighbours(v)){
+			out << u + 1 << " ";
+		}
+		out << "\n";
+	}
+	return 0;
+}
+
+static bool proper(const graph_access &G, const gls::colors &coloring){
+	for(NodeID v = 0; v < G.number_of_nodes(); v++){
+		for(NodeID u: G.neighbours(v)){
+			if(coloring[u] == coloring[v]){ return false; }
+		}
+	}
+	return true;
+}
+
+static int write_no(std::string filename){
+	std::ofstream out(filename.c_str());
+	if(!out){
+		std::cerr << "Error opening " << filename << std::endl;
+		return 1;
+	}
+	out << "NO\n";
+	return 0;
+}
+
+int main(int argc, const char* argv[]) {
+	if(argc < 7){
+		std::cerr << "Usage: " << argv[0] << " source.col target coloring graphs.csv group name [--binary]" << std::endl;
+		return 1;
+	}
+
+	std::string source = argv[1], target = argv[2], coloring_filename = argv[3], csv = argv[4];
+	std::string group = argv[5], name = argv[6];
+	bool binary = argc > 7 && std::string(argv[7]) == "--binary";
+
+	graph_access G;
+	dimacs_info info;
+	if(graph_io::readGraphDimacs(G, source, info)){
+		return 1;
+	}
+
+	int written = binary ? graph_io::writeGraphBinary(G, target) : graph_io::writeGraphWeighted(G, target);
+	if(written){
+		return 1;
+	}
+	if(binary){
+		// the checksum is verified once here, the solver only validates the header when it maps the file
+		graph_access B;
+		if(graph_io::readGraphBinary(B, target, true)){
+			return 1;
+		}
+	}
+
+	NodeID N = G.number_of_nodes();
+	EdgeID deg_min = N ? G.getNodeDegree(0) : 0, deg_max = 0;
+	for(NodeID v = 0; v < N; v++){
+		EdgeID degree = G.getNodeDegree(v);
+		if(degree < deg_min){ deg_min = degree; }
+		if(degree > deg_max){ deg_max = degree; }
+	}
+	double deg_avg = N ? double(G.number_of_edges()) / double(N) : 0.0;
+
+	gls::color d = gls::ColoringUpperBound::simple(G);
+	gls::color t2 = gls::ColoringUpperBound::theorem2(G);
+	gls::color t3 = gls::ColoringUpperBound::theorem3(G);
+	gls::color greedy = gls::EpocheRunner::get_colors(gls::ColoringBuilder::greedy(G));
+
+	gls::init();
+	gls::LOWER_BOUND = atoi(info.min.c_str());
+	// the coloring is written to its own file instead of the standard output
+	gls::DEBUG &= ~gls::DEBUG_OUTPUT;
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	gls::ColoringBuilder builder = gls::ColoringBuilder();
+	gls::EpocheRunner runner = gls::EpocheRunner();
+	gls::colors result = runner.solve(G, builder.build(G));
+	std::chrono::duration<double> gls_time = std::chrono::high_resolution_clock::now() - start;
+
+	// a coloring with conflicts is not written, the file and the gls column get "NO" like the output of gls.exe
+	bool solved = proper(G, result);
+	if(solved ? write_coloring(G, result, coloring_filename) : write_no(coloring_filename)){
+		return 1;
+	}
+
+	std::ofstream out(csv.c_str(), std::ios::app);
+	if(!out){
+		std::cerr << "Error opening " << csv << std::endl;
+		return 1;
+	}
+
+	const std::string q = "\"", sep = ";";
+	out << q << group << q << sep << q << name << q << sep
+		<< q << N << q << sep << q << G.number_of_edges() / 2 << q << sep
+		<< q << deg_min << q << sep << q << deg_max << q << sep << q << format_double(deg_avg) << q << sep
+		<< q << info.min << q << sep
+		<< q << d << q << sep << q << t2 << q << sep << q << t3 << q << sep << q << greedy << q << sep
+		<< q << (solved ? std::to_string(gls::EpocheRunner::get_colors(result)) : std::string("NO")) << q << sep << q << format_double(gls_time.count()) << q << sep
+		<< q << info.comment << q << "\n";
+
+	return 0;
+}
@@ -2,11 +2,10 @@
 
 #include "../data_structure/graph.h"
 #include "../data_structure/io/graph_io.h"
+#include "../data_structure/compressed_graph.h"
 #include "../coloring/gls.h"
 
 int main(int argc, const char* argv[]) {
-    srand(0);
-	
 	std::string graph_filename;
 	
 	if (argc <= 1){
@@ -16,18 +15,37 @@ int main(int argc, const char* argv[]) {
 	}
 	
 	graph_access G;
-	graph_io::readGraphWeighted(G, graph_filename);
+	if (graph_io::readGraph(G, graph_filename)) {
+		return 1;
+	}
 	
-	#ifdef UPPER
+	#if defined(CONVERT)
+	// Converts a METIS graph to the binary graph format, which is mapped directly on later runs.
+	// The written file is read back with its checksum, the later runs only validate the header.
+	std::string binary_filename = (argc <= 2) ? graph_filename + ".bin" : argv[2];
+	graph_access B;
+	return graph_io::writeGraphBinary(G, binary_filename) || graph_io::readGraphBinary(B, binary_filename, true);
+	#elif defined(UPPER)
 	std::cout << gls::ColoringUpperBound::simple(G) << ",";
 	std::cout << gls::ColoringUpperBound::theorem2(G) << ",";
 	std::cout << gls::ColoringUpperBound::theorem3(G) << ",";
-	std::cout << gls::EpocheRunner::get_colors(gls::ColoringBuilder::greedy(G)) << std::endl;
+	std::cout << gls::EpocheRunner::get_colors(gls::ColoringBuilder::greedy(G)) << ",";
+	std::cout << gls::ColoringLowerBound::spectral(G) << ",";
+	std::cout << gls::ColoringUpperBound::degeneracy(G) << std::endl;
 	#else
 	gls::init();
 	gls::ColoringBuilder builder = gls::ColoringBuilder();
 	gls::EpocheRunner runner = gls::EpocheRunner();
-	gls::colors result = runner.solve(G, builder.build(G));
+	gls::colors result;
+	if (gls::COMPRESS_GRAPH){
+		// Only the compressed adjacencies stay in memory during the search
+		compressed_graph C(G);
+		G.clear();
+		result = runner.solve(C, builder.build(C));
+	} else {
+		graph_view<> V = G.view();
+		result = runner.solve(V, builder.build(V));
+	}
 	#endif
 	return 0;
  }
@@ -0,0 +1,134 @@
+/******************************************************************************
+ * mapped_file.h
+ *
+ * Read-only memory mapping of a whole file. The mapping is shared through the
+ * page cache, so concurrent processes reading the same graph keep one copy.
+ *****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class mapped_file {
+public:
+    mapped_file() : m_data(NULL), m_size(0) {
+    }
+
+    ~mapped_file() {
+        close();
+    }
+
+    // maps the file read-only, returns false if it can not be opened or is empty
+    bool open(const std::string & filename);
+    void close();
+
+    const char* data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    bool is_open() const {
+        return m_data != NULL;
+    }
+
+    void swap(mapped_file & other) {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+    }
+
+private:
+    mapped_file(const mapped_file &);
+    mapped_file & operator=(const mapped_file &);
+
+    const char* m_data;
+    size_t m_size;
+};
+
+#ifdef _WIN32
+inline bool mapped_file::open(const std::string & filename) {
+    close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == NULL) {
+        return false;
+    }
+
+    m_data = static_cast<const char*>(view);
+    m_size = (size_t) size.QuadPart;
+    return true;
+}
+
+inline void mapped_file::close() {
+    if (m_data != NULL) {
+        UnmapViewOfFile(m_data);
+    }
+    m_data = NULL;
+    m_size = 0;
+}
+#else
+inline bool mapped_file::open(const std::string & filename) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+
+    m_data = static_cast<const char*>(view);
+    m_size = st.st_size;
+    return true;
+}
+
+inline void mapped_file::close() {
+    if (m_data != NULL) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+    m_data = NULL;
+    m_size = 0;
+}
+#endif
@@ -0,0 +1,128 @@
+/******************************************************************************
+ * parallel.h
+ *
+ * Minimal fork-join helpers on top of std::thread.
+ *****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// upper limit of worker threads, 0 means one per hardware thread
+inline unsigned & thread_limit() {
+    static unsigned limit = 0;
+    return limit;
+}
+
+inline unsigned threads() {
+    unsigned hardware = std::thread::hardware_concurrency();
+    if (hardware == 0) {
+        hardware = 1;
+    }
+    unsigned limit = thread_limit();
+    return (limit > 0 && limit < hardware) ? limit : hardware;
+}
+
+// number of blocks for work of the given size, so that each block gets at least grain items
+inline unsigned blocks_for(size_t size, size_t grain) {
+    size_t blocks = grain ? size / grain : size;
+    if (blocks < 1) {
+        blocks = 1;
+    }
+    return (unsigned) std::min<size_t>(blocks, threads());
+}
+
+// calls f(block) for every block in [0, blocks), each block on its own thread
+template <typename F>
+void for_each_block(unsigned blocks, F f) {
+    if (blocks <= 1) {
+        f(0u);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(blocks - 1);
+    for (unsigned b = 1; b < blocks; ++b) {
+        workers.push_back(std::thread(f, b));
+    }
+    f(0u);
+    for (std::thread & worker : workers) {
+        worker.join();
+    }
+}
+
+// calls f(begin, end) on disjoint ranges covering [0, size), at least grain items per range
+template <typename F>
+void for_range(size_t size, size_t grain, F f) {
+    unsigned blocks = blocks_for(size, grain);
+    for_each_block(blocks, [&](unsigned b) {
+        f(size * b / blocks, size * (b + 1) / blocks);
+    });
+}
+
+// stable LSD radix sort of data by key(item), which must be below 2^bits;
+// every pass counts the digits per block, places the blocks with a prefix sum
+// over (digit, block) and scatters each block on its own thread
+template <typename T, typename Key>
+void radix_sort(std::vector<T> & data, Key key, unsigned bits) {
+    const unsigned digit_bits = 8;
+    const size_t digits = size_t(1) << digit_bits;
+
+    size_t size = data.size();
+    unsigned blocks = blocks_for(size, 1 << 16);
+    std::vector<T> buffer(size);
+    std::vector<size_t> counts(blocks * digits);
+
+    for (unsigned shift = 0; shift < bits; shift += digit_bits) {
+        std::fill(counts.begin(), counts.end(), 0);
+        for_each_block(blocks, [&](unsigned b) {
+            size_t* count = &counts[b * digits];
+            for (size_t i = size * b / blocks, until = size * (b + 1) / blocks; i < until; ++i) {
+                count[(key(data[i]) >> shift) & (digits - 1)]++;
+            }
+        });
+
+        // a pass, in which all keys share the digit, does not change the order
+        bool trivial = false;
+        for (size_t d = 0; d < digits; ++d) {
+            size_t total = 0;
+            for (unsigned b = 0; b < blocks; ++b) {
+                total += counts[b * digits + d];
+            }
+            if (total == size) {
+                trivial = true;
+                break;
+            }
+            if (total > 0) {
+                break;
+            }
+        }
+        if (trivial) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t d = 0; d < digits; ++d) {
+            for (unsigned b = 0; b < blocks; ++b) {
+                size_t count = counts[b * digits + d];
+                counts[b * digits + d] = offset;
+                offset += count;
+            }
+        }
+
+        for_each_block(blocks, [&](unsigned b) {
+            size_t* position = &counts[b * digits];
+            for (size_t i = size * b / blocks, until = size * (b + 1) / blocks; i < until; ++i) {
+                buffer[position[(key(data[i]) >> shift) & (digits - 1)]++] = data[i];
+            }
+        });
+        data.swap(buffer);
+    }
+}
+
+}
@@ -0,0 +1,181 @@
+/******************************************************************************
+ * popcount.h
+ *
+ * Population count kernels over 64-bit word arrays. The POPCNT, AVX2 and
+ * AVX-512 versions are compiled for their targets and selected at run time by
+ * the instruction sets of the processor, otherwise the compiler builtin
+ * counts one word at a time.
+ *****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define POPCOUNT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define POPCOUNT_TARGET(isa)
+#else
+#define POPCOUNT_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace popcount {
+
+inline unsigned word(uint64_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return (unsigned) __popcnt64(x);
+#else
+    return (unsigned) __builtin_popcountll(x);
+#endif
+}
+
+// index of the lowest set bit, x must not be zero
+inline unsigned lowest(uint64_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (unsigned) index;
+#else
+    return (unsigned) __builtin_ctzll(x);
+#endif
+}
+
+enum Level { Portable, POPCNT, AVX2, AVX512 };
+
+// a kernel returns the number of bits set in both a and b
+typedef size_t (*kernel)(const uint64_t* a, const uint64_t* b, size_t words);
+
+inline size_t portable(const uint64_t* a, const uint64_t* b, size_t words) {
+    size_t result = 0;
+    for (size_t i = 0; i < words; ++i) {
+        result += word(a[i] & b[i]);
+    }
+    return result;
+}
+
+#ifdef POPCOUNT_X86
+// the undefined vectors of the AVX-512 headers of GCC warn in functions with a target attribute
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// the builtin is one instruction for this target, the default target calls a library function
+POPCOUNT_TARGET("popcnt")
+inline size_t popcnt(const uint64_t* a, const uint64_t* b, size_t words) {
+    size_t result = 0;
+    for (size_t i = 0; i < words; ++i) {
+        result += word(a[i] & b[i]);
+    }
+    return result;
+}
+
+// nibble lookup, the byte counts are summed into the 64-bit lanes with sad
+POPCOUNT_TARGET("avx2,popcnt")
+inline size_t avx2(const uint64_t* a, const uint64_t* b, size_t words) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i both = _mm256_and_si256(_mm256_loadu_si256((const __m256i*) (a + i)),
+                                        _mm256_loadu_si256((const __m256i*) (b + i)));
+        __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(both, low)),
+                                         _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(both, 4), low)));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+    size_t result = (size_t) _mm256_extract_epi64(sum, 0) + (size_t) _mm256_extract_epi64(sum, 1)
+                  + (size_t) _mm256_extract_epi64(sum, 2) + (size_t) _mm256_extract_epi64(sum, 3);
+    for (; i < words; ++i) {
+        result += word(a[i] & b[i]);
+    }
+    return result;
+}
+
+// 8 words per vector, the tail is loaded with a mask
+POPCOUNT_TARGET("avx512f,avx512vpopcntdq")
+inline size_t avx512(const uint64_t* a, const uint64_t* b, size_t words) {
+    __m512i sum = _mm512_setzero_si512();
+    for (size_t i = 0; i < words; i += 8) {
+        __mmask8 valid = (words - i >= 8) ? (__mmask8) 0xff : (__mmask8) ((1u << (words - i)) - 1);
+        __m512i both = _mm512_and_si512(_mm512_maskz_loadu_epi64(valid, a + i), _mm512_maskz_loadu_epi64(valid, b + i));
+        sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(both));
+    }
+    return (size_t) _mm512_reduce_add_epi64(sum);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+// the widest level, which the processor and the operating system support
+inline Level supported() {
+#ifdef POPCOUNT_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 23))) {
+        return Portable;
+    }
+    // the operating system saves the vector registers
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 0x6) != 0x6) {
+        return POPCNT;
+    }
+    bool avx512_state = (_xgetbv(0) & 0xe6) == 0xe6;
+    __cpuidex(info, 7, 0);
+    if (avx512_state && (info[1] & (1 << 16)) && (info[2] & (1 << 14))) {
+        return AVX512;
+    }
+    if (info[1] & (1 << 5)) {
+        return AVX2;
+    }
+    return POPCNT;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) {
+        return AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return AVX2;
+    }
+    if (__builtin_cpu_supports("popcnt")) {
+        return POPCNT;
+    }
+#endif
+#endif
+    return Portable;
+}
+
+inline kernel select(Level level) {
+#ifdef POPCOUNT_X86
+    switch (level) {
+        case AVX512:
+            return &avx512;
+        case AVX2:
+            return &avx2;
+        case POPCNT:
+            return &popcnt;
+        default:
+            break;
+    }
+#endif
+    return &portable;
+}
+
+// number of bits set in both a and b, with the kernel of the widest supported level, it is selected on the first call
+inline size_t count_and(const uint64_t* a, const uint64_t* b, size_t words) {
+    static const kernel best = select(supported());
+    return best(a, b, words);
+}
+
+}
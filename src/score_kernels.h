@@ -0,0 +1,279 @@
+/******************************************************************************
+ * score_kernels.h
+ *
+ * Kernels, which evaluate the one-exchange moves of a node to all k colors
+ * from its row of interleaved conflicts and guidance. The AVX2 and AVX-512
+ * versions are compiled for their targets and selected at run time by the
+ * instruction sets of the processor, otherwise one color is done at a time.
+ *****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define SCORE_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SCORE_KERNELS_TARGET(isa)
+#else
+#define SCORE_KERNELS_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace score_kernels {
+
+enum Level { Portable, AVX2, AVX512 };
+
+// A kernel reads the row as k pairs (conflicts, guidance) of the color of a node and writes
+// totals[c] = 10 * (conflicts[c] - conflicts[from]) + lambda * (guidance[c] - guidance[from]).
+// It returns the smallest total of a color other than from, or INT_MAX if there is none,
+// and sets the bits of ties, one per color, of the colors with that total.
+// ties has (k + 63) / 64 words, the totals have to fit in 32 bits.
+template <typename T>
+using kernel = int32_t (*)(const T* row, unsigned from, unsigned k, int32_t lambda, int32_t* totals, uint64_t* ties);
+
+// marks the colors from first on with the minimal total, the colors before first are already marked
+inline void mark_ties(const int32_t* totals, unsigned first, unsigned from, unsigned k, int32_t best, uint64_t* ties) {
+    for (unsigned c = first; c < k; ++c) {
+        if (totals[c] == best && c != from) {
+            ties[c >> 6] |= uint64_t(1) << (c & 63);
+        }
+    }
+}
+
+template <typename T>
+int32_t portable(const T* row, unsigned from, unsigned k, int32_t lambda, int32_t* totals, uint64_t* ties) {
+    int32_t conflicts = row[2 * from], guidance = row[2 * from + 1];
+    int32_t best = INT_MAX;
+    for (unsigned c = 0; c < k; ++c) {
+        totals[c] = 10 * (row[2 * c] - conflicts) + lambda * (row[2 * c + 1] - guidance);
+        if (c != from && totals[c] < best) {
+            best = totals[c];
+        }
+    }
+    std::memset(ties, 0, ((k + 63) / 64) * sizeof(uint64_t));
+    mark_ties(totals, 0, from, k, best, ties);
+    return best;
+}
+
+#ifdef SCORE_KERNELS_X86
+// the undefined vectors of the AVX-512 headers of GCC warn in functions with a target attribute
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// the total of from is excluded from the minimum, it is zero anyway
+SCORE_KERNELS_TARGET("avx2")
+inline int32_t avx2_minimum(__m256i minimum, const int32_t* totals, unsigned first, unsigned from, unsigned k) {
+    minimum = _mm256_min_epi32(minimum, _mm256_shuffle_epi32(minimum, _MM_SHUFFLE(1, 0, 3, 2)));
+    minimum = _mm256_min_epi32(minimum, _mm256_shuffle_epi32(minimum, _MM_SHUFFLE(2, 3, 0, 1)));
+    int32_t best = std::min(_mm256_extract_epi32(minimum, 0), _mm256_extract_epi32(minimum, 4));
+    for (unsigned c = first; c < k; ++c) {
+        if (c != from && totals[c] < best) {
+            best = totals[c];
+        }
+    }
+    return best;
+}
+
+SCORE_KERNELS_TARGET("avx2")
+inline void avx2_ties(const int32_t* totals, unsigned from, unsigned k, int32_t best, uint64_t* ties) {
+    std::memset(ties, 0, ((k + 63) / 64) * sizeof(uint64_t));
+    const __m256i target = _mm256_set1_epi32(best);
+    unsigned c = 0;
+    for (; c + 8 <= k; c += 8) {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) (totals + c)), target);
+        ties[c >> 6] |= uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(equal))) << (c & 63);
+    }
+    mark_ties(totals, c, from, k, best, ties);
+    if (from < c) {
+        ties[from >> 6] &= ~(uint64_t(1) << (from & 63));
+    }
+}
+
+// the minimum skips from by keeping INT_MAX in its lane
+SCORE_KERNELS_TARGET("avx2")
+inline __m256i avx2_skip(__m256i totals, unsigned c, unsigned from) {
+    __m256i lanes = _mm256_add_epi32(_mm256_set1_epi32(c), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i own = _mm256_cmpeq_epi32(lanes, _mm256_set1_epi32(from));
+    return _mm256_blendv_epi8(totals, _mm256_set1_epi32(INT_MAX), own);
+}
+
+// pairs of 16-bit scores: one madd with (10, lambda) gives the totals of 8 colors
+SCORE_KERNELS_TARGET("avx2")
+inline int32_t avx2(const int16_t* row, unsigned from, unsigned k, int32_t lambda, int32_t* totals, uint64_t* ties) {
+    int32_t pair;
+    std::memcpy(&pair, row + 2 * from, sizeof(pair));
+    const __m256i source = _mm256_set1_epi32(pair);
+    const __m256i weights = _mm256_set1_epi32((int32_t) (((uint32_t) lambda << 16) | 10));
+    __m256i minimum = _mm256_set1_epi32(INT_MAX);
+    unsigned c = 0;
+    for (; c + 8 <= k; c += 8) {
+        __m256i scores = _mm256_sub_epi16(_mm256_loadu_si256((const __m256i*) (row + 2 * c)), source);
+        __m256i result = _mm256_madd_epi16(scores, weights);
+        _mm256_storeu_si256((__m256i*) (totals + c), result);
+        minimum = _mm256_min_epi32(minimum, avx2_skip(result, c, from));
+    }
+    for (unsigned i = c; i < k; ++i) {
+        totals[i] = 10 * (row[2 * i] - row[2 * from]) + lambda * (row[2 * i + 1] - row[2 * from + 1]);
+    }
+    int32_t best = avx2_minimum(minimum, totals, c, from, k);
+    avx2_ties(totals, from, k, best, ties);
+    return best;
+}
+
+// pairs of 32-bit scores: the products of 4 colors in a vector are added pairwise, two vectors give 8 totals
+SCORE_KERNELS_TARGET("avx2")
+inline int32_t avx2(const int32_t* row, unsigned from, unsigned k, int32_t lambda, int32_t* totals, uint64_t* ties) {
+    int64_t pair;
+    std::memcpy(&pair, row + 2 * from, sizeof(pair));
+    const __m256i source = _mm256_set1_epi64x(pair);
+    const __m256i weights = _mm256_set1_epi64x((int64_t) (((uint64_t) (uint32_t) lambda << 32) | 10));
+    __m256i minimum = _mm256_set1_epi32(INT_MAX);
+    unsigned c = 0;
+    for (; c + 8 <= k; c += 8) {
+        __m256i low = _mm256_mullo_epi32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*) (row + 2 * c)), source), weights);
+        __m256i high = _mm256_mullo_epi32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*) (row + 2 * c + 8)), source), weights);
+        // hadd works inside the 128-bit lanes, the permutation restores the order of the colors
+        __m256i result = _mm256_permute4x64_epi64(_mm256_hadd_epi32(low, high), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i*) (totals + c), result);
+        minimum = _mm256_min_epi32(minimum, avx2_skip(result, c, from));
+    }
+    for (unsigned i = c; i < k; ++i) {
+        totals[i] = 10 * (row[2 * i] - row[2 * from]) + lambda * (row[2 * i + 1] - row[2 * from + 1]);
+    }
+    int32_t best = avx2_minimum(minimum, totals, c, from, k);
+    avx2_ties(totals, from, k, best, ties);
+    return best;
+}
+
+// the tail is loaded with a mask, so there is no scalar loop
+SCORE_KERNELS_TARGET("avx512f,avx512bw")
+inline int32_t avx512_finish(__m512i minimum, const int32_t* totals, unsigned from, unsigned k, uint64_t* ties) {
+    int32_t best = _mm512_reduce_min_epi32(minimum);
+    std::memset(ties, 0, ((k + 63) / 64) * sizeof(uint64_t));
+    const __m512i target = _mm512_set1_epi32(best);
+    for (unsigned c = 0; c < k; c += 16) {
+        __mmask16 valid = (k - c >= 16) ? (__mmask16) 0xffff : (__mmask16) ((1u << (k - c)) - 1);
+        __mmask16 equal = _mm512_mask_cmpeq_epi32_mask(valid, _mm512_maskz_loadu_epi32(valid, totals + c), target);
+        ties[c >> 6] |= uint64_t(equal) << (c & 63);
+    }
+    ties[from >> 6] &= ~(uint64_t(1) << (from & 63));
+    return best;
+}
+
+SCORE_KERNELS_TARGET("avx512f,avx512bw")
+inline __m512i avx512_skip(__m512i totals, unsigned c, unsigned from, __mmask16 valid) {
+    if (from >= c && from < c + 16) {
+        valid &= (__mmask16) ~(1u << (from - c));
+    }
+    return _mm512_mask_mov_epi32(_mm512_set1_epi32(INT_MAX), valid, totals);
+}
+
+// 16 colors of 16-bit pairs in a vector
+SCORE_KERNELS_TARGET("avx512f,avx512bw")
+inline int32_t avx512(const int16_t* row, unsigned from, unsigned k, int32_t lambda, int32_t* totals, uint64_t* ties) {
+    int32_t pair;
+    std::memcpy(&pair, row + 2 * from, sizeof(pair));
+    const __m512i source = _mm512_set1_epi32(pair);
+    const __m512i weights = _mm512_set1_epi32((int32_t) (((uint32_t) lambda << 16) | 10));
+    __m512i minimum = _mm512_set1_epi32(INT_MAX);
+    for (unsigned c = 0; c < k; c += 16) {
+        __mmask16 valid = (k - c >= 16) ? (__mmask16) 0xffff : (__mmask16) ((1u << (k - c)) - 1);
+        __m512i scores = _mm512_sub_epi16(_mm512_maskz_loadu_epi32(valid, row + 2 * c), source);
+        __m512i result = _mm512_madd_epi16(scores, weights);
+        _mm512_mask_storeu_epi32(totals + c, valid, result);
+        minimum = _mm512_min_epi32(minimum, avx512_skip(result, c, from, valid));
+    }
+    return avx512_finish(minimum, totals, from, k, ties);
+}
+
+// 8 colors of 32-bit pairs in a vector, the guidance products are added to the conflicts ones in the 64-bit lanes
+SCORE_KERNELS_TARGET("avx512f,avx512bw")
+inline int32_t avx512(const int32_t* row, unsigned from, unsigned k, int32_t lambda, int32_t* totals, uint64_t* ties) {
+    int64_t pair;
+    std::memcpy(&pair, row + 2 * from, sizeof(pair));
+    const __m512i source = _mm512_set1_epi64(pair);
+    const __m512i weights = _mm512_set1_epi64((int64_t) (((uint64_t) (uint32_t) lambda << 32) | 10));
+    __m512i minimum = _mm512_set1_epi32(INT_MAX);
+    for (unsigned c = 0; c < k; c += 8) {
+        __mmask8 valid = (k - c >= 8) ? (__mmask8) 0xff : (__mmask8) ((1u << (k - c)) - 1);
+        __m512i products = _mm512_mullo_epi32(_mm512_sub_epi32(_mm512_maskz_loadu_epi64(valid, row + 2 * c), source), weights);
+        __m512i sums = _mm512_add_epi32(products, _mm512_srli_epi64(products, 32));
+        _mm512_mask_cvtepi64_storeu_epi32(totals + c, valid, sums);
+        __m512i result = _mm512_castsi256_si512(_mm512_cvtepi64_epi32(sums));
+        minimum = _mm512_min_epi32(minimum, avx512_skip(result, c, from, valid));
+    }
+    return avx512_finish(minimum, totals, from, k, ties);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+// the widest level, which the processor and the operating system support
+inline Level supported() {
+#ifdef SCORE_KERNELS_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    // the operating system saves the vector registers
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 0x6) != 0x6) {
+        return Portable;
+    }
+    bool avx512_state = (_xgetbv(0) & 0xe6) == 0xe6;
+    __cpuidex(info, 7, 0);
+    if (avx512_state && (info[1] & (1 << 16)) && (info[1] & (1 << 30))) {
+        return AVX512;
+    }
+    if (info[1] & (1 << 5)) {
+        return AVX2;
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return AVX2;
+    }
+#endif
+#endif
+    return Portable;
+}
+
+template <typename T>
+kernel<T> select(Level level) {
+#ifdef SCORE_KERNELS_X86
+    switch (level) {
+        case AVX512:
+            return static_cast<kernel<T>>(&avx512);
+        case AVX2:
+            return static_cast<kernel<T>>(&avx2);
+        default:
+            break;
+    }
+#endif
+    return &portable<T>;
+}
+
+// evaluates a row with the kernel of the widest supported level, it is selected on the first call
+template <typename T>
+inline int32_t evaluate(const T* row, unsigned from, unsigned k, int32_t lambda, int32_t* totals, uint64_t* ties) {
+    static const kernel<T> best = select<T>(supported());
+    return best(row, from, k, lambda, totals, ties);
+}
+
+}